@@ -0,0 +1,327 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <triton/context.hpp>
+
+#include "target.hpp"
+#include "ttexplore.hpp"
+
+#ifndef KRACKME_BINARY
+#define KRACKME_BINARY "krackme_1.out"
+#endif
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+/* The seed of the README, it takes the deepest path of the crackme */
+static const triton::uint8 BENCH_SEED[] = {
+    'K', 'C', 'T', 'F', '{', 'k', 'R', 'a', 'C', 'k', '_', 'M', '3',
+    '_', 'o', 'N', 'e', '_', '0', '_', 'f', 'L', 'a', 'G', '_', 'c',
+    '0', 'x', 's', '_', 'b', 'A', 'z', 'a', 'r', '}', 0xff, 0xff, 0xff,
+    0xff};
+
+/* Timings of one benchmark, in ns */
+struct BenchResult {
+  std::string name;
+  std::vector<double> samples;
+  std::vector<std::pair<std::string, double>> extra;
+};
+
+/* Options of the command line */
+struct BenchOptions {
+  std::string binary = KRACKME_BINARY;
+  std::string workspace; /* parent of the workspaces, empty: temp dir */
+  std::string out;
+  std::string filter;
+  triton::usize repeat = 0; /* 0: the default of each benchmark */
+};
+
+class ExploratorBench {
+private:
+  const BenchOptions &options;
+  std::vector<BenchResult> results;
+
+  /* Workspaces made by the bench, the only ones it removes */
+  std::vector<std::string> workspaces;
+
+  static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  }
+
+  triton::usize repeat(triton::usize fallback) const {
+    return this->options.repeat ? this->options.repeat : fallback;
+  }
+
+  bool selected(const std::string &name) const {
+    return this->options.filter.empty() ||
+           name.find(this->options.filter) != std::string::npos;
+  }
+
+  /* A fresh empty directory, never one the user already had */
+  std::string makeWorkspace(void) {
+    const std::filesystem::path parent =
+        this->options.workspace.empty()
+            ? std::filesystem::temp_directory_path()
+            : std::filesystem::path(this->options.workspace);
+    std::filesystem::create_directories(parent);
+    auto path = (parent / "bench-XXXXXX").string();
+    if (mkdtemp(&path[0]) == nullptr) {
+      throw std::runtime_error("Cannot create a workspace in " +
+                               parent.string());
+    }
+    this->workspaces.push_back(path);
+    return path;
+  }
+
+  /* Deterministic exploration: one worker, synchronous solver */
+  void configure(SymbolicExplorator &ex) {
+    ex.config.workers = 1;
+    ex.config.solver_threads = 0;
+    ex.config.rng_seed = 0;
+    ex.config.stats = false;
+    ex.config.quiet = true;
+    ex.config.checkpoint_interval = 0;
+    ex.config.resume = false;
+    ex.config.workspace = this->makeWorkspace();
+    ex.config.target = KRACKME_SUCCESS;
+    hookTarget(ex);
+  }
+
+  /* Make the bench seed the task of the worker */
+  Seed open(SymbolicExplorator &ex, Worker &w) const {
+    Seed seed(BENCH_SEED, BENCH_SEED + sizeof(BENCH_SEED));
+    seed.resize(ex.layout.size(), 0);
+    ex.openTask(w, SeedEntry{seed, 0, true, 0});
+    SymbolicExplorator::current = &w;
+    return seed;
+  }
+
+  /* Forget what the previous repetition asked and found */
+  void forget(SymbolicExplorator &ex) const {
+    ex.donelist.clear();
+    ex.queries.reset(ex.config.query_cache);
+    ex.candidates.reset(ex.config.reuse_candidates);
+    ex.worklist.resize(1, ex.config.schedule, ex.config.restart_interval,
+                       ex.config.rng_seed);
+  }
+
+  void close(SymbolicExplorator &ex, Worker &w) const {
+    ex.restoreContext(w);
+    w.icache.endRun();
+    ex.closeTask(w.task);
+    w.task.reset();
+    SymbolicExplorator::current = nullptr;
+  }
+
+  void micro(void) {
+    triton::Context ctx;
+    loadTarget(&ctx, this->options.binary);
+    SymbolicExplorator ex(&ctx);
+    this->configure(ex);
+    ex.setup();
+    auto &w = ex.workers[0];
+
+    /* Full copy of the initial context into the backup one */
+    if (this->selected("snapshot")) {
+      BenchResult r{"snapshot", {}, {}};
+      for (triton::usize i = 0; i < this->repeat(200); i++) {
+        auto start = std::chrono::steady_clock::now();
+        ex.snapshotContext(ex.bck_ctx, ex.ini_ctx);
+        r.samples.push_back(since(start));
+      }
+      this->results.push_back(std::move(r));
+    }
+
+    /* Emulation of the bench seed, with the symbolic EA queries it asks */
+    if (this->selected("run") || this->selected("symbolize_ea")) {
+      BenchResult run{"run", {}, {}};
+      BenchResult ea{"symbolize_ea", {}, {}};
+      for (triton::usize i = 0; i < this->repeat(10); i++) {
+        this->forget(ex);
+        auto seed = this->open(ex, w);
+        ex.injectSeed(w, seed);
+        const auto before = ex.metrics.total(PHASE_SYMBOLIZE_EA);
+        auto start = std::chrono::steady_clock::now();
+        ex.run(w, seed);
+        run.samples.push_back(since(start));
+        ea.samples.push_back(ex.metrics.total(PHASE_SYMBOLIZE_EA) - before);
+        this->close(ex, w);
+      }
+      run.extra.emplace_back("worklist", ex.worklist.size());
+      if (this->selected("run")) {
+        this->results.push_back(std::move(run));
+      }
+      if (this->selected("symbolize_ea")) {
+        this->results.push_back(std::move(ea));
+      }
+    }
+
+    /* Branch queries of the path recorded by the bench seed */
+    if (this->selected("find_inputs")) {
+      BenchResult r{"find_inputs", {}, {}};
+      for (triton::usize i = 0; i < this->repeat(10); i++) {
+        auto seed = this->open(ex, w);
+        ex.injectSeed(w, seed);
+        ex.run(w, seed);
+        this->forget(ex);
+        auto start = std::chrono::steady_clock::now();
+        ex.findNewInputs(w);
+        r.samples.push_back(since(start));
+        r.extra.assign({{"seeds", static_cast<double>(ex.worklist.size())}});
+        this->close(ex, w);
+      }
+      this->results.push_back(std::move(r));
+    }
+
+    ex.teardown();
+  }
+
+  /* Whole exploration, until the worklist drains */
+  void solve(void) {
+    if (!this->selected("solve")) {
+      return;
+    }
+    BenchResult r{"solve", {}, {}};
+    triton::usize solved = 0;
+    triton::usize execs = 0;
+    std::vector<double> solutionExecs;
+    std::vector<double> solutionTimes;
+    for (triton::usize i = 0; i < this->repeat(1); i++) {
+      triton::Context ctx;
+      loadTarget(&ctx, this->options.binary);
+      SymbolicExplorator ex(&ctx);
+      this->configure(ex);
+      auto start = std::chrono::steady_clock::now();
+      ex.explore();
+      r.samples.push_back(since(start));
+      execs = ex.nbexec;
+
+      /* An execution reached the success message of the crackme */
+      if (ex.solved) {
+        solved++;
+        solutionExecs.push_back(ex.solutionExec);
+        solutionTimes.push_back(ex.solutionTime);
+      }
+    }
+    r.extra.emplace_back("execs", execs);
+    r.extra.emplace_back("solved", solved);
+    if (!solutionExecs.empty()) {
+      std::sort(solutionExecs.begin(), solutionExecs.end());
+      std::sort(solutionTimes.begin(), solutionTimes.end());
+      r.extra.emplace_back("solution_execs",
+                           solutionExecs[solutionExecs.size() / 2]);
+      r.extra.emplace_back("solution_median_ns",
+                           solutionTimes[solutionTimes.size() / 2]);
+    }
+    this->results.push_back(std::move(r));
+  }
+
+public:
+  explicit ExploratorBench(const BenchOptions &options) : options(options) {}
+
+  ~ExploratorBench() {
+    for (const auto &dir : this->workspaces) {
+      std::filesystem::remove_all(dir);
+    }
+  }
+
+  void runAll(void) {
+    this->micro();
+    this->solve();
+  }
+
+  void write(std::ostream &out) const {
+    out << "{\n  \"binary\": \"" << this->options.binary
+        << "\",\n  \"benchmarks\": [";
+    for (triton::usize i = 0; i < this->results.size(); i++) {
+      const auto &r = this->results[i];
+      auto sorted = r.samples;
+      std::sort(sorted.begin(), sorted.end());
+      double mean = 0, var = 0;
+      for (auto v : sorted) {
+        mean += v;
+      }
+      mean /= std::max<triton::usize>(sorted.size(), 1);
+      for (auto v : sorted) {
+        var += (v - mean) * (v - mean);
+      }
+      var /= std::max<triton::usize>(sorted.size(), 1);
+
+      out << (i ? "," : "") << "\n    {\"name\": \"" << r.name
+          << "\", \"repeat\": " << sorted.size();
+      if (!sorted.empty()) {
+        out << std::fixed << ", \"mean_ns\": " << mean
+            << ", \"median_ns\": " << sorted[sorted.size() / 2]
+            << ", \"min_ns\": " << sorted.front()
+            << ", \"max_ns\": " << sorted.back()
+            << ", \"stddev_ns\": " << std::sqrt(var);
+      }
+      for (const auto &e : r.extra) {
+        out << ", \"" << e.first << "\": " << e.second;
+      }
+      out << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+  }
+};
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
+
+/* Time the phases of the exploration on the crackme */
+int main(int argc, char *argv[]) {
+  triton::engines::exploration::BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--binary") {
+      options.binary = argv[++i];
+    } else if (i + 1 < argc && arg == "--workspace") {
+      options.workspace = argv[++i];
+    } else if (i + 1 < argc && arg == "--out") {
+      options.out = argv[++i];
+    } else if (i + 1 < argc && arg == "--filter") {
+      options.filter = argv[++i];
+    } else if (i + 1 < argc && arg == "--repeat") {
+      options.repeat = std::stoul(argv[++i]);
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--binary <elf>] [--workspace <dir>] [--out <json>]"
+                << " [--filter <name>] [--repeat <n>]" << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    triton::engines::exploration::ExploratorBench bench(options);
+    bench.runAll();
+    if (options.out.empty()) {
+      bench.write(std::cout);
+    } else {
+      std::ofstream out(options.out);
+      bench.write(out);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <triton/exceptions.hpp>
+
+#include "checkpoint.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+/* Little helpers over a byte buffer, values are stored in host order */
+template <typename T> static void put(std::vector<char> &out, const T &v) {
+  const char *p = reinterpret_cast<const char *>(&v);
+  out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static void putArray(std::vector<char> &out, const std::vector<T> &v) {
+  put<triton::uint64>(out, v.size());
+  const char *p = reinterpret_cast<const char *>(v.data());
+  out.insert(out.end(), p, p + v.size() * sizeof(T));
+}
+
+template <typename T>
+static void get(const std::vector<char> &in, triton::usize &pos, T &v) {
+  if (pos + sizeof(T) > in.size()) {
+    throw triton::exceptions::Engines(
+        "Checkpoint::read(): Truncated checkpoint.");
+  }
+  std::memcpy(&v, in.data() + pos, sizeof(T));
+  pos += sizeof(T);
+}
+
+template <typename T>
+static void getArray(const std::vector<char> &in, triton::usize &pos,
+                     std::vector<T> &v) {
+  triton::uint64 n = 0;
+  get(in, pos, n);
+  if (n > (in.size() - pos) / sizeof(T)) {
+    throw triton::exceptions::Engines(
+        "Checkpoint::read(): Truncated checkpoint.");
+  }
+  v.resize(n);
+  std::memcpy(v.data(), in.data() + pos, n * sizeof(T));
+  pos += n * sizeof(T);
+}
+
+void Checkpoint::write(const std::string &path) const {
+  std::vector<char> out;
+  out.reserve(64 + this->donelist.size() * sizeof(triton::uint64) +
+              this->virgin.size() * 5 + this->seeds.size() * this->seedSize);
+
+  put(out, CHECKPOINT_MAGIC);
+  put(out, this->nbexec);
+  put(out, this->nbsat);
+  put(out, this->nbunsat);
+  put(out, this->nbtimeout);
+  put(out, this->seedSize);
+
+  put<triton::uint64>(out, this->seeds.size());
+  for (const auto &entry : this->seeds) {
+    put(out, entry.hits);
+    put<triton::uint8>(out, entry.novel);
+    putArray(out, entry.seed);
+  }
+  putArray(out, this->donelist);
+  putArray(out, this->virgin);
+  putArray(out, this->hits);
+  putArray(out, this->pcs);
+
+  const auto tmp = path + ".tmp";
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    f.write(out.data(), out.size());
+    if (!f) {
+      throw triton::exceptions::Engines(
+          "Checkpoint::write(): Cannot write " + tmp + ".");
+    }
+  }
+  std::filesystem::rename(tmp, path);
+}
+
+bool Checkpoint::read(const std::string &path) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+  std::vector<char> in((std::istreambuf_iterator<char>(f)),
+                       std::istreambuf_iterator<char>());
+
+  triton::usize pos = 0;
+  triton::uint64 magic = 0;
+  get(in, pos, magic);
+  if (magic != CHECKPOINT_MAGIC) {
+    throw triton::exceptions::Engines("Checkpoint::read(): Invalid magic in " +
+                                      path + ".");
+  }
+  get(in, pos, this->nbexec);
+  get(in, pos, this->nbsat);
+  get(in, pos, this->nbunsat);
+  get(in, pos, this->nbtimeout);
+  get(in, pos, this->seedSize);
+
+  triton::uint64 nbseeds = 0;
+  get(in, pos, nbseeds);
+  this->seeds.clear();
+  for (triton::uint64 i = 0; i < nbseeds; i++) {
+    SeedEntry entry{};
+    triton::uint8 novel = 0;
+    get(in, pos, entry.hits);
+    get(in, pos, novel);
+    getArray(in, pos, entry.seed);
+    entry.novel = novel;
+    this->seeds.push_back(std::move(entry));
+  }
+  getArray(in, pos, this->donelist);
+  getArray(in, pos, this->virgin);
+  getArray(in, pos, this->hits);
+  getArray(in, pos, this->pcs);
+
+  return true;
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
@@ -0,0 +1,101 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_CHECKPOINT_H
+#define TRITON_CHECKPOINT_H
+
+
+#include <string>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+#include "scheduler.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Name of the checkpoint file in the workspace.
+      constexpr const char* CHECKPOINT_FILE = "checkpoint.bin";
+
+      //! Magic at the start of a checkpoint.
+      constexpr triton::uint64 CHECKPOINT_MAGIC = 0x3130544e50484354; /* "TCHPNT01" */
+
+      /*! \class Checkpoint
+          \brief Saved state of an exploration.
+
+          The seeds are the ones left to run, the donelist keys are the
+          queries whose answers are already among them. The file is
+          written beside the previous one and renamed over it, so a kill
+          during a write leaves the previous checkpoint intact. */
+      class Checkpoint {
+        public:
+          //! Executions so far.
+          triton::uint64 nbexec = 0;
+
+          //! SAT answers so far.
+          triton::uint64 nbsat = 0;
+
+          //! UNSAT answers so far.
+          triton::uint64 nbunsat = 0;
+
+          //! Timeouts so far.
+          triton::uint64 nbtimeout = 0;
+
+          //! Size of a seed, a checkpoint only fits the same target.
+          triton::uint64 seedSize = 0;
+
+          //! Seeds to run.
+          std::vector<SeedEntry> seeds;
+
+          //! Answered queries.
+          std::vector<triton::uint64> donelist;
+
+          //! Coverage buckets seen per slot.
+          std::vector<triton::uint8> virgin;
+
+          //! Coverage hits per slot.
+          std::vector<triton::uint32> hits;
+
+          //! Covered instructions.
+          std::vector<triton::uint64> pcs;
+
+          //! Write the checkpoint to path.
+          void write(const std::string& path) const;
+
+          //! Read the checkpoint from path. Returns false if there is none.
+          bool read(const std::string& path);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_CHECKPOINT_H */
@@ -0,0 +1,200 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <algorithm>
+#include <chrono>
+
+#include <triton/astContext.hpp>
+
+#include "concretize.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+static const char *const EA_STRATEGY_NAMES[EA_STRATEGY_COUNT] = {
+    "none", "all", "sample", "range", "pages", "array"};
+
+const char *EaConcretizer::name(ea_strategy_e strategy) {
+  return strategy < EA_STRATEGY_COUNT ? EA_STRATEGY_NAMES[strategy]
+                                      : "unknown";
+}
+
+bool EaConcretizer::parse(const std::string &name, ea_strategy_e &strategy) {
+  for (triton::usize i = 0; i < EA_STRATEGY_COUNT; i++) {
+    if (name == EA_STRATEGY_NAMES[i]) {
+      strategy = static_cast<ea_strategy_e>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+EaConcretizer::EaConcretizer(
+    triton::Context *ctx, const triton::ast::SharedAbstractNode &predicate,
+    const triton::ast::SharedAbstractNode &ea, triton::uint32 timeout,
+    triton::usize probes)
+    : ctx(ctx), predicate(predicate), ea(ea), timeout(timeout),
+      probes(probes) {}
+
+triton::engines::solver::status_e
+EaConcretizer::check(const triton::ast::SharedAbstractNode &cond,
+                     Models &models) {
+  auto ast = this->ctx->getAstContext();
+  triton::engines::solver::status_e status;
+
+  auto start = std::chrono::steady_clock::now();
+  auto model = this->ctx->getModel(ast->land(this->predicate, cond), &status,
+                                   this->timeout);
+  this->time += std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  this->queries++;
+
+  if (status == triton::engines::solver::SAT) {
+    models.push_back(std::move(model));
+  } else if (status == triton::engines::solver::TIMEOUT) {
+    this->timedOut = true;
+  }
+  return status;
+}
+
+bool EaConcretizer::bound(bool upper, triton::uint64 value,
+                          triton::uint64 &out, Models &models) {
+  auto ast = this->ctx->getAstContext();
+  const auto size = this->ea->getBitvectorSize();
+  const triton::uint64 mask =
+      size >= 64 ? ~static_cast<triton::uint64>(0)
+                 : (static_cast<triton::uint64>(1) << size) - 1;
+  const triton::uint64 limit = upper ? mask : 0;
+
+  /* good is reachable, bad is not */
+  auto probe = [&](triton::uint64 at, Models &m) {
+    return this->check(upper ? ast->bvuge(this->ea, ast->bv(at, size))
+                             : ast->bvule(this->ea, ast->bv(at, size)),
+                       m);
+  };
+  /* Out of probes, the furthest reachable address so far is the bound */
+  const auto stop = this->queries + this->probes;
+  auto spent = [&]() { return this->probes && this->queries >= stop; };
+  triton::uint64 good = value;
+  triton::uint64 bad = limit;
+  bool blocked = false;
+  Models best;
+
+  /* Gallop away from the current address */
+  triton::uint64 step = 1;
+  while (good != limit && !spent()) {
+    triton::uint64 at;
+    if (upper) {
+      at = mask - good <= step ? mask : good + step;
+    } else {
+      at = good <= step ? 0 : good - step;
+    }
+    Models m;
+    const auto status = probe(at, m);
+    if (status == triton::engines::solver::TIMEOUT) {
+      return false;
+    }
+    if (status != triton::engines::solver::SAT) {
+      bad = at;
+      blocked = true;
+      break;
+    }
+    good = at;
+    best = std::move(m);
+    step = step << 1 ? step << 1 : step;
+  }
+
+  /* Then bisect the last step */
+  while (blocked && (upper ? bad - good : good - bad) > 1 && !spent()) {
+    const triton::uint64 at =
+        upper ? good + (bad - good) / 2 : bad + (good - bad) / 2;
+    Models m;
+    const auto status = probe(at, m);
+    if (status == triton::engines::solver::TIMEOUT) {
+      return false;
+    }
+    if (status == triton::engines::solver::SAT) {
+      good = at;
+      best = std::move(m);
+    } else {
+      bad = at;
+    }
+  }
+
+  /* The last model is at the bound, none if it is the current address */
+  out = good;
+  for (auto &model : best) {
+    models.push_back(std::move(model));
+  }
+  return true;
+}
+
+bool EaConcretizer::range(triton::uint64 &min, triton::uint64 &max,
+                          Models &models) {
+  const auto value = static_cast<triton::uint64>(this->ea->evaluate());
+  min = max = value;
+  return this->bound(false, value, min, models) &&
+         this->bound(true, value, max, models);
+}
+
+void EaConcretizer::pages(triton::uint64 min, triton::uint64 max,
+                          triton::usize limit, Models &models) {
+  auto ast = this->ctx->getAstContext();
+  const auto size = this->ea->getBitvectorSize();
+  const auto current =
+      static_cast<triton::uint64>(this->ea->evaluate()) / EA_PAGE_SIZE;
+  const auto first = min / EA_PAGE_SIZE;
+  const auto last = max / EA_PAGE_SIZE;
+  if (limit == 0 || last <= first) {
+    return;
+  }
+
+  /* Every page if they fit, else limit of them evenly spread, both ends
+   * included */
+  std::vector<triton::uint64> picked;
+  if (last - first <= limit) {
+    for (auto page = first; page <= last; page++) {
+      picked.push_back(page);
+    }
+  } else if (limit == 1) {
+    picked.push_back(current == first ? last : first);
+  } else {
+    const auto stride = (last - first) / (limit - 1);
+    for (triton::usize i = 0; i + 1 < limit; i++) {
+      picked.push_back(first + stride * i);
+    }
+    picked.push_back(last);
+  }
+
+  for (const auto page : picked) {
+    if (page == current) {
+      continue;
+    }
+    const auto lo = std::max(min, page * EA_PAGE_SIZE);
+    const auto hi = std::min(max, page * EA_PAGE_SIZE + EA_PAGE_SIZE - 1);
+    this->check(ast->land(ast->bvuge(this->ea, ast->bv(lo, size)),
+                          ast->bvule(this->ea, ast->bv(hi, size))),
+                models);
+  }
+}
+
+triton::uint64 EaConcretizer::getTime(void) const { return this->time; }
+
+triton::usize EaConcretizer::getQueries(void) const { return this->queries; }
+
+triton::engines::solver::status_e
+EaConcretizer::getStatus(const Models &models) const {
+  if (!models.empty()) {
+    return triton::engines::solver::SAT;
+  }
+  return this->timedOut ? triton::engines::solver::TIMEOUT
+                        : triton::engines::solver::UNSAT;
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
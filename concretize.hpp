@@ -0,0 +1,133 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_CONCRETIZE_H
+#define TRITON_CONCRETIZE_H
+
+
+#include <string>
+
+#include <triton/ast.hpp>
+#include <triton/context.hpp>
+#include <triton/solverEnums.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include "solverpool.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Granularity of the page sampling.
+      constexpr triton::uint64 EA_PAGE_SIZE = 0x1000;
+
+      //! How a new symbolic effective address is turned into seeds.
+      enum ea_strategy_e {
+        EA_STRATEGY_NONE = 0, /* pin the address, no query */
+        EA_STRATEGY_ALL,      /* up to ea_model other addresses */
+        EA_STRATEGY_SAMPLE,   /* up to ea_samples other addresses */
+        EA_STRATEGY_RANGE,    /* the lowest and highest addresses */
+        EA_STRATEGY_PAGES,    /* one address by page of the range */
+        EA_STRATEGY_ARRAY,    /* small ranges stay symbolic, else range */
+        EA_STRATEGY_COUNT,
+      };
+
+      /*! \class EaConcretizer
+          \brief Range queries on one symbolic effective address.
+
+          Queries are synchronous, all under the same path predicate. The
+          bounds are found by galloping away from the current address then
+          bisecting, so a table of n entries costs about 2 log n queries
+          whatever the width of the address. A bound gives up after a
+          number of probes and keeps the furthest address reached. */
+      class EaConcretizer {
+        private:
+          //! Context of the execution.
+          triton::Context* ctx;
+
+          //! Path predicate of the access.
+          triton::ast::SharedAbstractNode predicate;
+
+          //! The effective address.
+          triton::ast::SharedAbstractNode ea;
+
+          //! Timeout of a query, as given to the solver.
+          triton::uint32 timeout;
+
+          //! Max queries for each bound, 0: no limit.
+          triton::usize probes;
+
+          //! Solver time (us).
+          triton::uint64 time = 0;
+
+          //! Number of queries.
+          triton::usize queries = 0;
+
+          //! True if a query timed out.
+          bool timedOut = false;
+
+          //! Check cond under the path predicate, fills model if SAT.
+          triton::engines::solver::status_e check(const triton::ast::SharedAbstractNode& cond, Models& models);
+
+          //! Furthest address below (or above) value, with the model reaching it.
+          bool bound(bool upper, triton::uint64 value, triton::uint64& out, Models& models);
+
+        public:
+          //! Name of a strategy.
+          static const char* name(ea_strategy_e strategy);
+
+          //! Strategy of a name, false if unknown.
+          static bool parse(const std::string& name, ea_strategy_e& strategy);
+
+          //! Constructor.
+          EaConcretizer(triton::Context* ctx, const triton::ast::SharedAbstractNode& predicate,
+                        const triton::ast::SharedAbstractNode& ea, triton::uint32 timeout,
+                        triton::usize probes = 0);
+
+          //! Bounds of the address, with a model for each bound not reached yet. False on timeout.
+          bool range(triton::uint64& min, triton::uint64& max, Models& models);
+
+          //! One model by page of [min, max] but the current one, at most limit spread over the range.
+          void pages(triton::uint64 min, triton::uint64 max, triton::usize limit, Models& models);
+
+          //! Solver time (us).
+          triton::uint64 getTime(void) const;
+
+          //! Number of queries.
+          triton::usize getQueries(void) const;
+
+          //! SAT with models, TIMEOUT if a query timed out, else UNSAT.
+          triton::engines::solver::status_e getStatus(const Models& models) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_CONCRETIZE_H */
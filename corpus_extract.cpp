@@ -0,0 +1,28 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <exception>
+#include <iostream>
+
+#include "corpusstore.hpp"
+
+/* Unpack a packed store into the one-file-per-seed layout */
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <store dir> <output dir>"
+              << std::endl;
+    return 1;
+  }
+
+  try {
+    auto n = triton::engines::exploration::CorpusReader::extract(argv[1],
+                                                                 argv[2]);
+    std::cout << n << " seeds written in " << argv[2] << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
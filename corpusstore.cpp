@@ -0,0 +1,269 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include <triton/exceptions.hpp>
+
+#include "corpusstore.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+static_assert(sizeof(CorpusEntry) == 40, "CorpusEntry is written as is");
+
+CorpusStore::~CorpusStore() { this->close(); }
+
+triton::uint64 CorpusStore::hash(const triton::uint8 *data,
+                                 triton::usize size) {
+  /* FNV-1a, with the length folded in */
+  triton::uint64 h = 0xcbf29ce484222325 ^ size;
+  for (triton::usize i = 0; i < size; i++) {
+    h = (h ^ data[i]) * 0x100000001b3;
+  }
+  return h;
+}
+
+void CorpusStore::open(const std::string &dir) {
+  std::lock_guard<std::mutex> guard(this->lock);
+
+  std::filesystem::create_directories(dir);
+  const auto dpath = dir + "/" + CORPUS_DATA_FILE;
+  const auto ipath = dir + "/" + CORPUS_INDEX_FILE;
+
+  /* Reload what is already stored */
+  this->hashes.clear();
+  this->count = 0;
+  this->duplicates = 0;
+  this->dataSize = 0;
+  const triton::uint64 isize = std::filesystem::exists(ipath)
+                                   ? std::filesystem::file_size(ipath)
+                                   : 0;
+  if (isize > sizeof(CORPUS_MAGIC)) {
+    CorpusReader reader;
+    reader.open(dir);
+    for (triton::usize i = 0; i < reader.size(); i++) {
+      const auto &e = reader.entry(i);
+      this->hashes.insert(e.hash);
+      this->dataSize = std::max(this->dataSize, e.offset + e.length);
+    }
+    this->count = reader.size();
+  }
+
+  /* Cut a torn tail left by a crash, the appends must stay aligned on the
+   * entries and the data they point to */
+  const bool fresh = isize < sizeof(CORPUS_MAGIC);
+  if (std::filesystem::exists(ipath)) {
+    std::filesystem::resize_file(
+        ipath, fresh ? 0
+                     : sizeof(CORPUS_MAGIC) + this->count * sizeof(CorpusEntry));
+  }
+  if (std::filesystem::exists(dpath)) {
+    std::filesystem::resize_file(dpath, this->dataSize);
+  }
+
+  this->data.open(dpath, std::ios::binary | std::ios::app);
+  this->index.open(ipath, std::ios::binary | std::ios::app);
+  if (!this->data.is_open() || !this->index.is_open()) {
+    throw triton::exceptions::Engines(
+        "CorpusStore::open(): Cannot open the store in " + dir + ".");
+  }
+  if (fresh) {
+    this->index.write(reinterpret_cast<const char *>(&CORPUS_MAGIC),
+                      sizeof(CORPUS_MAGIC));
+  }
+}
+
+void CorpusStore::close(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  if (this->data.is_open()) {
+    this->flushLocked();
+    this->data.close();
+    this->index.close();
+  }
+}
+
+bool CorpusStore::append(const Seed &seed, triton::uint64 exec, bool novel,
+                         triton::uint64 output) {
+  return this->append(seed.data(), seed.size(), exec, novel, output);
+}
+
+bool CorpusStore::append(const void *data, triton::usize size,
+                         triton::uint64 exec, bool novel,
+                         triton::uint64 output) {
+  const auto bytes = static_cast<const triton::uint8 *>(data);
+  const auto h = CorpusStore::hash(bytes, size);
+
+  std::lock_guard<std::mutex> guard(this->lock);
+  if (this->hashes.insert(h).second == false) {
+    this->duplicates++;
+    return false;
+  }
+
+  CorpusEntry entry;
+  entry.hash = h;
+  entry.offset = this->dataSize;
+  entry.exec = exec;
+  entry.length = static_cast<triton::uint32>(size);
+  entry.novel = novel;
+  entry.output = output;
+
+  this->dataBuffer.insert(this->dataBuffer.end(), bytes, bytes + size);
+  this->indexBuffer.push_back(entry);
+  this->dataSize += size;
+  this->count++;
+
+  if (this->dataBuffer.size() +
+          this->indexBuffer.size() * sizeof(CorpusEntry) >=
+      CORPUS_FLUSH_SIZE) {
+    this->flushLocked();
+  }
+  return true;
+}
+
+void CorpusStore::flush(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->flushLocked();
+}
+
+void CorpusStore::flushLocked(void) {
+  if (!this->data.is_open()) {
+    return;
+  }
+
+  /* Data first, an entry never points past the data file */
+  this->data.write(this->dataBuffer.data(), this->dataBuffer.size());
+  this->data.flush();
+  this->index.write(reinterpret_cast<const char *>(this->indexBuffer.data()),
+                    this->indexBuffer.size() * sizeof(CorpusEntry));
+  this->index.flush();
+  this->dataBuffer.clear();
+  this->indexBuffer.clear();
+}
+
+triton::usize CorpusStore::size(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->count;
+}
+
+triton::usize CorpusStore::dropped(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->duplicates;
+}
+
+CorpusReader::~CorpusReader() { this->close(); }
+
+const triton::uint8 *CorpusReader::map(const std::string &path,
+                                       triton::usize &size) {
+  size = 0;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw triton::exceptions::Engines("CorpusReader::map(): Cannot open " +
+                                      path + ".");
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw triton::exceptions::Engines("CorpusReader::map(): Cannot stat " +
+                                      path + ".");
+  }
+  if (st.st_size == 0) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    throw triton::exceptions::Engines("CorpusReader::map(): Cannot map " +
+                                      path + ".");
+  }
+
+  size = st.st_size;
+  return static_cast<const triton::uint8 *>(addr);
+}
+
+void CorpusReader::open(const std::string &dir) {
+  this->close();
+  this->indexMap =
+      CorpusReader::map(dir + "/" + CORPUS_INDEX_FILE, this->indexSize);
+  this->dataMap =
+      CorpusReader::map(dir + "/" + CORPUS_DATA_FILE, this->dataSize);
+
+  triton::uint64 magic = 0;
+  if (this->indexSize >= sizeof(magic)) {
+    std::memcpy(&magic, this->indexMap, sizeof(magic));
+  }
+  if (magic != CORPUS_MAGIC) {
+    this->close();
+    throw triton::exceptions::Engines(
+        "CorpusReader::open(): Invalid index in " + dir + ".");
+  }
+
+  /* A torn last entry is ignored, an entry past the data is an error */
+  for (triton::usize i = 0; i < this->size(); i++) {
+    const auto &e = this->entry(i);
+    if (e.offset + e.length > this->dataSize) {
+      this->close();
+      throw triton::exceptions::Engines(
+          "CorpusReader::open(): Truncated data in " + dir + ".");
+    }
+  }
+}
+
+void CorpusReader::close(void) {
+  if (this->dataMap) {
+    munmap(const_cast<triton::uint8 *>(this->dataMap), this->dataSize);
+  }
+  if (this->indexMap) {
+    munmap(const_cast<triton::uint8 *>(this->indexMap), this->indexSize);
+  }
+  this->dataMap = nullptr;
+  this->indexMap = nullptr;
+  this->dataSize = 0;
+  this->indexSize = 0;
+}
+
+triton::usize CorpusReader::size(void) const {
+  if (this->indexSize < sizeof(CORPUS_MAGIC)) {
+    return 0;
+  }
+  return (this->indexSize - sizeof(CORPUS_MAGIC)) / sizeof(CorpusEntry);
+}
+
+const CorpusEntry &CorpusReader::entry(triton::usize i) const {
+  return reinterpret_cast<const CorpusEntry *>(this->indexMap +
+                                               sizeof(CORPUS_MAGIC))[i];
+}
+
+const triton::uint8 *CorpusReader::seed(triton::usize i) const {
+  return this->dataMap + this->entry(i).offset;
+}
+
+triton::usize CorpusReader::extract(const std::string &dir,
+                                    const std::string &outdir) {
+  CorpusReader reader;
+  reader.open(dir);
+  std::filesystem::create_directories(outdir);
+  for (triton::usize i = 0; i < reader.size(); i++) {
+    const auto &e = reader.entry(i);
+    std::ofstream f(outdir + "/" + std::to_string(e.exec), std::ios::binary);
+    f.write(reinterpret_cast<const char *>(reader.seed(i)), e.length);
+  }
+  return reader.size();
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
@@ -0,0 +1,201 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_CORPUSSTORE_H
+#define TRITON_CORPUSSTORE_H
+
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+#include "scheduler.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Name of the data file of a store.
+      constexpr const char* CORPUS_DATA_FILE = "seeds.dat";
+
+      //! Name of the index file of a store.
+      constexpr const char* CORPUS_INDEX_FILE = "seeds.idx";
+
+      //! Magic at the start of an index file.
+      constexpr triton::uint64 CORPUS_MAGIC = 0x3230535250524f43; /* "CORPRS02" */
+
+      //! Buffered bytes before the store is flushed.
+      constexpr triton::usize CORPUS_FLUSH_SIZE = 1 << 20;
+
+      //! Entry of the index, one per stored seed.
+      struct CorpusEntry {
+        //! Content hash of the seed.
+        triton::uint64 hash;
+
+        //! Offset of the seed in the data file.
+        triton::uint64 offset;
+
+        //! Execution that stored the seed, also its name in the old layout.
+        triton::uint64 exec;
+
+        //! Length of the seed in bytes.
+        triton::uint32 length;
+
+        //! True if the execution of the seed hit new edges or printed something new.
+        triton::uint32 novel;
+
+        //! Content hash of what the execution printed.
+        triton::uint64 output;
+      };
+
+      /*! \class CorpusStore
+          \brief Append-only store of seeds.
+
+          Seeds are appended to one data file and described by a fixed-size
+          entry in an index file. Both writes are buffered and identical seeds
+          are stored once. Reopening a store appends to it. */
+      class CorpusStore {
+        private:
+          //! Serializes the appends.
+          std::mutex lock;
+
+          //! Data file.
+          std::ofstream data;
+
+          //! Index file.
+          std::ofstream index;
+
+          //! Pending bytes of the data file.
+          std::vector<char> dataBuffer;
+
+          //! Pending entries of the index file.
+          std::vector<CorpusEntry> indexBuffer;
+
+          //! Size of the data file, pending bytes included.
+          triton::uint64 dataSize = 0;
+
+          //! Hashes of the stored seeds.
+          std::unordered_set<triton::uint64> hashes;
+
+          //! Number of stored seeds.
+          triton::usize count = 0;
+
+          //! Number of dropped duplicates.
+          triton::usize duplicates = 0;
+
+          //! Write the pending bytes, lock held.
+          void flushLocked(void);
+
+        public:
+          //! Destructor, flushes the store.
+          ~CorpusStore();
+
+          //! Returns the content hash of a seed.
+          static triton::uint64 hash(const triton::uint8* data, triton::usize size);
+
+          //! Open or create the store in dir.
+          void open(const std::string& dir);
+
+          //! Flush and close the store.
+          void close(void);
+
+          //! Append a seed. Returns false if the same seed is already stored.
+          bool append(const Seed& seed, triton::uint64 exec, bool novel, triton::uint64 output = 0);
+
+          //! Append raw bytes. Returns false if the same bytes are already stored.
+          bool append(const void* data, triton::usize size, triton::uint64 exec, bool novel, triton::uint64 output = 0);
+
+          //! Write the pending bytes.
+          void flush(void);
+
+          //! Number of stored seeds.
+          triton::usize size(void);
+
+          //! Number of dropped duplicates.
+          triton::usize dropped(void);
+      };
+
+      /*! \class CorpusReader
+          \brief Read-only view of a store, mapped in memory. */
+      class CorpusReader {
+        private:
+          //! Mapped data file.
+          const triton::uint8* dataMap = nullptr;
+
+          //! Size of the data mapping.
+          triton::usize dataSize = 0;
+
+          //! Mapped index file.
+          const triton::uint8* indexMap = nullptr;
+
+          //! Size of the index mapping.
+          triton::usize indexSize = 0;
+
+          //! Map a file read-only. Returns nullptr on an empty file.
+          static const triton::uint8* map(const std::string& path, triton::usize& size);
+
+        public:
+          //! Constructor.
+          CorpusReader() = default;
+
+          //! Not copyable, owns the mappings.
+          CorpusReader(const CorpusReader&) = delete;
+          CorpusReader& operator=(const CorpusReader&) = delete;
+
+          //! Destructor, unmaps the store.
+          ~CorpusReader();
+
+          //! Map the store in dir.
+          void open(const std::string& dir);
+
+          //! Unmap the store.
+          void close(void);
+
+          //! Number of seeds.
+          triton::usize size(void) const;
+
+          //! Returns the index entry of seed i.
+          const CorpusEntry& entry(triton::usize i) const;
+
+          //! Returns the bytes of seed i, entry(i).length long.
+          const triton::uint8* seed(triton::usize i) const;
+
+          //! Write each seed of the store in dir to outdir/<exec>. Returns the number of files.
+          static triton::usize extract(const std::string& dir, const std::string& outdir);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_CORPUSSTORE_H */
@@ -0,0 +1,140 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "coverage.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+constexpr triton::usize COMPACT_MIN = 4096;
+
+EdgeTrace::EdgeTrace() {
+  this->counts.resize(COVERAGE_MAP_SIZE, 0);
+  this->compactAt = COMPACT_MIN;
+  this->prev = 0;
+}
+
+void EdgeTrace::decoded(triton::uint64 pc) {
+  this->pcs.push_back(pc);
+
+  /* Without the decode cache every step decodes, keep the list to about
+   * twice the distinct instructions */
+  if (this->pcs.size() >= this->compactAt) {
+    std::sort(this->pcs.begin(), this->pcs.end());
+    this->pcs.erase(std::unique(this->pcs.begin(), this->pcs.end()),
+                    this->pcs.end());
+    this->compactAt = std::max(COMPACT_MIN, this->pcs.size() * 2);
+  }
+}
+
+void EdgeTrace::reset(void) {
+  for (const auto slot : this->touched) {
+    this->counts[slot] = 0;
+  }
+  this->touched.clear();
+  this->pcs.clear();
+  this->compactAt = COMPACT_MIN;
+  this->prev = 0;
+}
+
+CoverageMap::CoverageMap() {
+  this->virgin.resize(COVERAGE_MAP_SIZE, 0);
+  this->hits.resize(COVERAGE_MAP_SIZE, 0);
+  this->nbedges = 0;
+}
+
+triton::uint8 CoverageMap::bucket(triton::uint8 count) {
+  if (count <= 3)
+    return 1 << (count - 1);
+  if (count <= 7)
+    return 1 << 3;
+  if (count <= 15)
+    return 1 << 4;
+  if (count <= 31)
+    return 1 << 5;
+  if (count <= 127)
+    return 1 << 6;
+  return 1 << 7;
+}
+
+bool CoverageMap::merge(EdgeTrace &trace) {
+  bool novel = false;
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    for (const auto slot : trace.touched) {
+      const auto count = trace.counts[slot];
+      const auto bit = CoverageMap::bucket(count);
+
+      if (this->virgin[slot] == 0) {
+        this->nbedges++;
+      }
+      if ((this->virgin[slot] & bit) == 0) {
+        this->virgin[slot] |= bit;
+        novel = true;
+      }
+
+      auto &total = this->hits[slot];
+      total = (total > std::numeric_limits<triton::uint32>::max() - count)
+                  ? std::numeric_limits<triton::uint32>::max()
+                  : total + count;
+    }
+    this->pcs.insert(trace.pcs.begin(), trace.pcs.end());
+  }
+  trace.reset();
+  return novel;
+}
+
+triton::uint32 CoverageMap::slotHits(triton::uint32 slot) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->hits[slot & (COVERAGE_MAP_SIZE - 1)];
+}
+
+triton::usize CoverageMap::edges(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->nbedges;
+}
+
+triton::usize CoverageMap::instructions(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->pcs.size();
+}
+
+std::vector<triton::uint64> CoverageMap::instructionList(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return std::vector<triton::uint64>(this->pcs.begin(), this->pcs.end());
+}
+
+void CoverageMap::save(std::vector<triton::uint8> &virgin,
+                       std::vector<triton::uint32> &hits,
+                       std::vector<triton::uint64> &pcs) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  virgin = this->virgin;
+  hits = this->hits;
+  pcs.assign(this->pcs.begin(), this->pcs.end());
+}
+
+void CoverageMap::load(const std::vector<triton::uint8> &virgin,
+                       const std::vector<triton::uint32> &hits,
+                       const std::vector<triton::uint64> &pcs) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->virgin = virgin;
+  this->hits = hits;
+  this->virgin.resize(COVERAGE_MAP_SIZE, 0);
+  this->hits.resize(COVERAGE_MAP_SIZE, 0);
+  this->pcs.clear();
+  this->pcs.insert(pcs.begin(), pcs.end());
+  this->nbedges = 0;
+  for (const auto bits : this->virgin) {
+    this->nbedges += (bits != 0);
+  }
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
@@ -0,0 +1,160 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_COVERAGE_H
+#define TRITON_COVERAGE_H
+
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Number of edge slots (power of two).
+      constexpr triton::usize COVERAGE_MAP_SIZE = 1 << 16;
+
+      /*! \class EdgeTrace
+          \brief AFL-style edge hit counts of one execution.
+
+          An edge (prev_pc, pc) is counted in the slot
+          hash(pc) ^ (hash(prev_pc) >> 1), with saturating 8-bit counters.
+          The slots touched for the first time are remembered, so merging a
+          run costs its number of edges, not the size of the map. The
+          executed instructions are kept apart and exactly, slots collide,
+          but only when they are decoded: with the decode cache, once per
+          worker and not at each step. */
+      class EdgeTrace {
+        public:
+          //! Hit counts of the execution.
+          std::vector<triton::uint8> counts;
+
+          //! Slots touched by the execution.
+          std::vector<triton::uint32> touched;
+
+          //! Instructions decoded by the execution, deduplicated now and then.
+          std::vector<triton::uint64> pcs;
+
+          //! Size of pcs that triggers the next deduplication.
+          triton::usize compactAt;
+
+          //! Shifted location of the previous instruction.
+          triton::uint32 prev;
+
+          //! Constructor.
+          EdgeTrace();
+
+          //! Returns the location of an instruction in the map.
+          static inline triton::uint32 location(triton::uint64 pc) {
+            return static_cast<triton::uint32>(((pc >> 4) ^ (pc << 8) ^ pc) * 0x9e3779b1) & (COVERAGE_MAP_SIZE - 1);
+          }
+
+          //! Returns the slot of the edge from prev to pc.
+          static inline triton::uint32 slot(triton::uint64 prev, triton::uint64 pc) {
+            return EdgeTrace::location(pc) ^ (EdgeTrace::location(prev) >> 1);
+          }
+
+          //! Count the edge from the previous instruction to pc.
+          inline void hit(triton::uint64 pc) {
+            const triton::uint32 cur = EdgeTrace::location(pc);
+            const triton::uint32 slot = cur ^ this->prev;
+            auto& count = this->counts[slot];
+            if (count != 0xff) {
+              if (count++ == 0) {
+                this->touched.push_back(slot);
+              }
+            }
+            this->prev = cur >> 1;
+          }
+
+          //! Record an instruction decoded, not taken from the decode cache.
+          void decoded(triton::uint64 pc);
+
+          //! Clear the counts of the touched slots.
+          void reset(void);
+      };
+
+      /*! \class CoverageMap
+          \brief Edge coverage accumulated over all executions. */
+      class CoverageMap {
+        private:
+          //! Protects the map.
+          std::mutex lock;
+
+          //! Hit count buckets already seen per slot (one bit per bucket).
+          std::vector<triton::uint8> virgin;
+
+          //! Cumulated hits per slot.
+          std::vector<triton::uint32> hits;
+
+          //! Number of slots hit at least once.
+          triton::usize nbedges;
+
+          //! Covered instructions.
+          std::unordered_set<triton::uint64> pcs;
+
+          //! Returns the AFL bucket bit of a hit count.
+          static triton::uint8 bucket(triton::uint8 count);
+
+        public:
+          //! Constructor.
+          CoverageMap();
+
+          //! Merge an execution and reset it. Returns true if it hit a new edge or a new hit count bucket.
+          bool merge(EdgeTrace& trace);
+
+          //! Cumulated hits of a slot.
+          triton::uint32 slotHits(triton::uint32 slot);
+
+          //! Number of covered edges.
+          triton::usize edges(void);
+
+          //! Number of covered instructions.
+          triton::usize instructions(void);
+
+          //! Copy of the covered instructions.
+          std::vector<triton::uint64> instructionList(void);
+
+          //! Copy the whole map out.
+          void save(std::vector<triton::uint8>& virgin, std::vector<triton::uint32>& hits, std::vector<triton::uint64>& pcs);
+
+          //! Replace the whole map by a saved one.
+          void load(const std::vector<triton::uint8>& virgin, const std::vector<triton::uint32>& hits, const std::vector<triton::uint64>& pcs);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_COVERAGE_H */
@@ -0,0 +1,135 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <triton/callbacks.hpp>
+#include <triton/callbacksEnums.hpp>
+
+#include "decodecache.hpp"
+#include "dirtystate.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+DecodeCache::DecodeCache() {
+  this->ctx = nullptr;
+  this->nbhit = 0;
+  this->nbmiss = 0;
+}
+
+void DecodeCache::attach(triton::Context *ctx) {
+  this->detach();
+  this->ctx = ctx;
+  this->ctx->addCallback(
+      triton::callbacks::SET_CONCRETE_MEMORY_VALUE,
+      triton::callbacks::setConcreteMemoryValueCallback(
+          [this](triton::Context &ctx, const triton::arch::MemoryAccess &mem,
+                 const triton::uint512 &value) {
+            this->onMemory(ctx, mem, value);
+          },
+          this));
+}
+
+void DecodeCache::detach(void) {
+  if (this->ctx == nullptr) {
+    return;
+  }
+  /* Callbacks compare by id, the function is not used */
+  this->ctx->removeCallback(
+      triton::callbacks::SET_CONCRETE_MEMORY_VALUE,
+      triton::callbacks::setConcreteMemoryValueCallback(
+          [](triton::Context &, const triton::arch::MemoryAccess &,
+             const triton::uint512 &) {},
+          this));
+  this->ctx = nullptr;
+  this->entries.clear();
+  this->codePages.clear();
+  this->writtenPages.clear();
+}
+
+void DecodeCache::onMemory(triton::Context &ctx,
+                           const triton::arch::MemoryAccess &mem,
+                           const triton::uint512 &value) {
+  const triton::uint64 first = mem.getAddress() & ~(DIRTY_PAGE_SIZE - 1);
+  const triton::uint64 last =
+      (mem.getAddress() + mem.getSize() - 1) & ~(DIRTY_PAGE_SIZE - 1);
+
+  /* Most writes land in data pages */
+  if (this->codePages.find(first) == this->codePages.end() &&
+      this->codePages.find(last) == this->codePages.end()) {
+    return;
+  }
+
+  this->writtenPages.insert(first);
+  this->writtenPages.insert(last);
+  this->invalidate(mem.getAddress(), mem.getSize());
+}
+
+void DecodeCache::invalidate(triton::uint64 addr, triton::uint32 size) {
+  /* An instruction starting up to DECODE_MAX_SIZE - 1 bytes before addr may
+   * overlap the write */
+  const triton::uint64 start =
+      addr >= DECODE_MAX_SIZE - 1 ? addr - (DECODE_MAX_SIZE - 1) : 0;
+  for (triton::uint64 pc = start; pc < addr + size; pc++) {
+    auto it = this->entries.find(pc);
+    if (it != this->entries.end() && pc + it->second.getSize() > addr) {
+      this->entries.erase(it);
+    }
+  }
+}
+
+const triton::arch::Instruction *DecodeCache::lookup(triton::uint64 pc) {
+  auto it = this->entries.find(pc);
+  if (it == this->entries.end()) {
+    this->nbmiss.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  this->nbhit.fetch_add(1, std::memory_order_relaxed);
+  return &it->second;
+}
+
+void DecodeCache::insert(const triton::arch::Instruction &inst) {
+  const triton::uint32 size = inst.getSize();
+  if (size == 0 || size > DECODE_MAX_SIZE) {
+    return;
+  }
+
+  this->entries[inst.getAddress()] = inst;
+
+  this->codePages.insert(inst.getAddress() & ~(DIRTY_PAGE_SIZE - 1));
+  this->codePages.insert((inst.getAddress() + size - 1) &
+                         ~(DIRTY_PAGE_SIZE - 1));
+}
+
+void DecodeCache::endRun(void) {
+  if (this->writtenPages.empty()) {
+    return;
+  }
+
+  /* Self-modifying code, the bytes cached from these pages are gone */
+  for (auto it = this->entries.begin(); it != this->entries.end();) {
+    const triton::uint64 page = it->first & ~(DIRTY_PAGE_SIZE - 1);
+    const triton::uint64 last =
+        (it->first + it->second.getSize() - 1) & ~(DIRTY_PAGE_SIZE - 1);
+    if (this->writtenPages.count(page) || this->writtenPages.count(last)) {
+      it = this->entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  this->writtenPages.clear();
+}
+
+triton::usize DecodeCache::hits(void) const {
+  return this->nbhit;
+}
+
+triton::usize DecodeCache::misses(void) const {
+  return this->nbmiss;
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
@@ -0,0 +1,115 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_DECODECACHE_H
+#define TRITON_DECODECACHE_H
+
+
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <triton/context.hpp>
+#include <triton/instruction.hpp>
+#include <triton/memoryAccess.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Max size of an instruction.
+      constexpr triton::uint32 DECODE_MAX_SIZE = 16;
+
+      /*! \class DecodeCache
+          \brief Disassembled instructions, keyed by PC.
+
+          An entry is the instruction as left by the disassembly, before its
+          semantics are built: a hit is copied and only goes through
+          buildSemantics(). The cache lives as long as its worker, across executions. A write
+          into a page holding cached code drops the overlapping entries, and
+          every entry of such a page is dropped again when the execution ends,
+          because the restore puts the original bytes back. */
+      class DecodeCache {
+        private:
+          //! Observed context.
+          triton::Context* ctx;
+
+          //! Cached instructions: <pc: entry>
+          std::unordered_map<triton::uint64, triton::arch::Instruction> entries;
+
+          //! Pages holding at least one cached instruction.
+          std::unordered_set<triton::uint64> codePages;
+
+          //! Code pages written during the current execution.
+          std::unordered_set<triton::uint64> writtenPages;
+
+          //! Number of hits.
+          std::atomic<triton::usize> nbhit;
+
+          //! Number of misses.
+          std::atomic<triton::usize> nbmiss;
+
+          //! Memory write callback.
+          void onMemory(triton::Context& ctx, const triton::arch::MemoryAccess& mem, const triton::uint512& value);
+
+          //! Drop the entries overlapping [addr, addr + size).
+          void invalidate(triton::uint64 addr, triton::uint32 size);
+
+        public:
+          //! Constructor.
+          DecodeCache();
+
+          //! Start observing the writes of ctx.
+          void attach(triton::Context* ctx);
+
+          //! Stop observing and drop every entry.
+          void detach(void);
+
+          //! Returns the cached instruction at pc or nullptr.
+          const triton::arch::Instruction* lookup(triton::uint64 pc);
+
+          //! Cache a disassembled instruction, its semantics not built yet.
+          void insert(const triton::arch::Instruction& inst);
+
+          //! Drop the entries of the code pages written by the execution.
+          void endRun(void);
+
+          //! Number of hits.
+          triton::usize hits(void) const;
+
+          //! Number of misses.
+          triton::usize misses(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_DECODECACHE_H */
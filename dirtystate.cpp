@@ -0,0 +1,151 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <triton/callbacksEnums.hpp>
+#include <triton/callbacks.hpp>
+
+#include "dirtystate.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+DirtyState::DirtyState() {
+  this->ctx = nullptr;
+  this->restoring = false;
+}
+
+void DirtyState::attach(triton::Context *ctx) {
+  this->detach();
+  this->ctx = ctx;
+  this->ctx->addCallback(
+      triton::callbacks::SET_CONCRETE_MEMORY_VALUE,
+      triton::callbacks::setConcreteMemoryValueCallback(
+          [this](triton::Context &ctx, const triton::arch::MemoryAccess &mem,
+                 const triton::uint512 &value) {
+            this->onMemory(ctx, mem, value);
+          },
+          this));
+  this->ctx->addCallback(
+      triton::callbacks::SET_CONCRETE_REGISTER_VALUE,
+      triton::callbacks::setConcreteRegisterValueCallback(
+          [this](triton::Context &ctx, const triton::arch::Register &reg,
+                 const triton::uint512 &value) {
+            this->onRegister(ctx, reg, value);
+          },
+          this));
+}
+
+void DirtyState::detach(void) {
+  if (this->ctx == nullptr) {
+    return;
+  }
+  /* Callbacks compare by id, the functions are not used */
+  this->ctx->removeCallback(
+      triton::callbacks::SET_CONCRETE_MEMORY_VALUE,
+      triton::callbacks::setConcreteMemoryValueCallback(
+          [](triton::Context &, const triton::arch::MemoryAccess &,
+             const triton::uint512 &) {},
+          this));
+  this->ctx->removeCallback(
+      triton::callbacks::SET_CONCRETE_REGISTER_VALUE,
+      triton::callbacks::setConcreteRegisterValueCallback(
+          [](triton::Context &, const triton::arch::Register &,
+             const triton::uint512 &) {},
+          this));
+  this->ctx = nullptr;
+  this->pages.clear();
+  this->registers.clear();
+}
+
+void DirtyState::onMemory(triton::Context &ctx,
+                          const triton::arch::MemoryAccess &mem,
+                          const triton::uint512 &value) {
+  if (this->restoring) {
+    return;
+  }
+  const triton::uint64 addr = mem.getAddress();
+  for (triton::uint32 i = 0; i < mem.getSize(); i++) {
+    const triton::uint64 byte = addr + i;
+    this->pages[byte & ~(DIRTY_PAGE_SIZE - 1)].set(byte &
+                                                   (DIRTY_PAGE_SIZE - 1));
+  }
+}
+
+void DirtyState::onRegister(triton::Context &ctx,
+                            const triton::arch::Register &reg,
+                            const triton::uint512 &value) {
+  if (this->restoring) {
+    return;
+  }
+  this->registers.insert(ctx.getParentRegister(reg.getId()).getId());
+}
+
+void DirtyState::restore(triton::Context *bck) {
+  this->restoring = true;
+
+  /* Registers */
+  for (const auto id : this->registers) {
+    const auto &reg =
+        this->ctx->getRegister(static_cast<triton::arch::register_e>(id));
+    this->ctx->setConcreteRegisterValue(
+        reg, bck->getConcreteRegisterValue(reg, false), false);
+    const auto &expr = bck->getSymbolicRegister(reg);
+    if (expr != nullptr) {
+      this->ctx->assignSymbolicExpressionToRegister(expr, reg);
+    } else {
+      this->ctx->concretizeRegister(reg);
+    }
+  }
+
+  /* Memory, byte by byte inside the written pages */
+  for (const auto &page : this->pages) {
+    for (triton::uint64 i = 0; i < DIRTY_PAGE_SIZE; i++) {
+      if (page.second.test(i) == false) {
+        continue;
+      }
+      const triton::uint64 addr = page.first + i;
+      if (bck->isConcreteMemoryValueDefined(addr, 1)) {
+        this->ctx->setConcreteMemoryValue(
+            addr, bck->getConcreteMemoryValue(addr, false), false);
+      } else {
+        this->ctx->clearConcreteMemoryValue(addr, 1);
+      }
+      auto expr = bck->getSymbolicMemory(addr);
+      if (expr != nullptr) {
+        this->ctx->assignSymbolicExpressionToMemory(
+            expr, triton::arch::MemoryAccess(addr, triton::size::byte));
+      } else {
+        this->ctx->concretizeMemory(addr);
+      }
+    }
+  }
+
+  /* Path predicate */
+  this->ctx->clearPathConstraints();
+  for (const auto &pc : bck->getPathConstraints()) {
+    this->ctx->pushPathConstraint(pc);
+  }
+
+  this->pages.clear();
+  this->registers.clear();
+  this->restoring = false;
+}
+
+triton::usize DirtyState::dirtyBytes(void) const {
+  triton::usize count = 0;
+  for (const auto &page : this->pages) {
+    count += page.second.count();
+  }
+  return count;
+}
+
+triton::usize DirtyState::dirtyRegisters(void) const {
+  return this->registers.size();
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
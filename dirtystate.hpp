@@ -0,0 +1,103 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_DIRTYSTATE_H
+#define TRITON_DIRTYSTATE_H
+
+
+#include <bitset>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <triton/context.hpp>
+#include <triton/memoryAccess.hpp>
+#include <triton/register.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Granularity of the memory write set.
+      constexpr triton::uint64 DIRTY_PAGE_SIZE = 0x1000;
+
+      /*! \class DirtyState
+          \brief Records what an execution writes and rolls back only that.
+
+          Concrete writes are observed through the SET_CONCRETE_MEMORY_VALUE
+          and SET_CONCRETE_REGISTER_VALUE callbacks. Memory is tracked per
+          page with a byte bitmap, registers by parent id. Restoring copies
+          back the concrete and symbolic state of the written locations only,
+          so its cost follows the write set of the run instead of the size of
+          the whole state. */
+      class DirtyState {
+        private:
+          //! Tracked context.
+          triton::Context* ctx;
+
+          //! True while restore() writes into ctx.
+          bool restoring;
+
+          //! Written bytes: <page base: bytes of the page>
+          std::unordered_map<triton::uint64, std::bitset<DIRTY_PAGE_SIZE>> pages;
+
+          //! Written registers (parent ids).
+          std::unordered_set<triton::uint32> registers;
+
+          //! Memory write callback.
+          void onMemory(triton::Context& ctx, const triton::arch::MemoryAccess& mem, const triton::uint512& value);
+
+          //! Register write callback.
+          void onRegister(triton::Context& ctx, const triton::arch::Register& reg, const triton::uint512& value);
+
+        public:
+          //! Constructor.
+          DirtyState();
+
+          //! Start tracking the writes of ctx. ctx must be in the state restore() will go back to.
+          void attach(triton::Context* ctx);
+
+          //! Stop tracking.
+          void detach(void);
+
+          //! Roll back the tracked context to bck and clear the write set.
+          void restore(triton::Context* bck);
+
+          //! Number of bytes written since the last restore.
+          triton::usize dirtyBytes(void) const;
+
+          //! Number of registers written since the last restore.
+          triton::usize dirtyRegisters(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_DIRTYSTATE_H */
@@ -0,0 +1,80 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <algorithm>
+
+#include "donelist.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+triton::uint64 Donelist::extend(triton::uint64 path, triton::uint64 addr) {
+  /* Order sensitive combine, then the splitmix64 finalizer */
+  triton::uint64 x =
+      path ^ (addr + 0x9e3779b97f4a7c15 + (path << 6) + (path >> 2));
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111eb;
+  x ^= x >> 31;
+  return x;
+}
+
+bool Donelist::insert(triton::uint64 key) {
+  auto &shard = this->shards[key >> 60];
+  std::lock_guard<std::mutex> guard(shard.lock);
+  if (shard.keys.insert(key).second == false) {
+    return false;
+  }
+  shard.journal.push_back(key);
+  return true;
+}
+
+bool Donelist::contains(triton::uint64 key) {
+  auto &shard = this->shards[key >> 60];
+  std::lock_guard<std::mutex> guard(shard.lock);
+  return shard.keys.find(key) != shard.keys.end();
+}
+
+triton::usize Donelist::size(void) {
+  triton::usize count = 0;
+  for (auto &shard : this->shards) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    count += shard.keys.size();
+  }
+  return count;
+}
+
+void Donelist::marks(Marks &out) {
+  for (triton::usize i = 0; i < SHARDS; i++) {
+    std::lock_guard<std::mutex> guard(this->shards[i].lock);
+    out[i] = this->shards[i].journal.size();
+  }
+}
+
+void Donelist::journal(const Marks &from, const Marks &to,
+                       std::vector<triton::uint64> &out) {
+  for (triton::usize i = 0; i < SHARDS; i++) {
+    auto &shard = this->shards[i];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    const auto end = std::min(to[i], shard.journal.size());
+    for (triton::usize k = from[i]; k < end; k++) {
+      out.push_back(shard.journal[k]);
+    }
+  }
+}
+
+void Donelist::clear(void) {
+  for (auto &shard : this->shards) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    shard.keys.clear();
+    shard.journal.clear();
+  }
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
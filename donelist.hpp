@@ -0,0 +1,103 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_DONELIST_H
+#define TRITON_DONELIST_H
+
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Hash of the empty path.
+      constexpr triton::uint64 PATH_HASH_INIT = 0xcbf29ce484222325;
+
+      /*! \class Donelist
+          \brief Set of already solved (path prefix, target) pairs.
+
+          A path is encoded as a rolling hash of its branch addresses, so
+          extending it by one branch and recording a pair are O(1) and each
+          recorded pair costs one 64-bit key whatever the path length. The set
+          is sharded to keep the workers from serializing on one lock. Each
+          shard also journals its keys in insertion order, so a checkpoint
+          only copies the keys recorded since the previous one. */
+      class Donelist {
+        public:
+          //! Number of shards.
+          static constexpr triton::usize SHARDS = 16;
+
+          //! Journal positions, one per shard.
+          using Marks = std::array<triton::usize, SHARDS>;
+
+        private:
+          //! A shard of the set.
+          struct shard_s {
+            std::mutex lock;
+            std::unordered_set<triton::uint64> keys;
+            std::vector<triton::uint64> journal;
+          };
+
+          //! Shards, selected by the high bits of the key.
+          std::array<shard_s, SHARDS> shards;
+
+        public:
+          //! Returns the hash of path extended by addr.
+          static triton::uint64 extend(triton::uint64 path, triton::uint64 addr);
+
+          //! Records a key. Returns false if it was already there.
+          bool insert(triton::uint64 key);
+
+          //! Returns true if the key has been recorded.
+          bool contains(triton::uint64 key);
+
+          //! Number of recorded keys.
+          triton::usize size(void);
+
+          //! Current end of the journals.
+          void marks(Marks& out);
+
+          //! Append the keys journaled between from and to to out, shard by shard.
+          void journal(const Marks& from, const Marks& to, std::vector<triton::uint64>& out);
+
+          //! Drop every key.
+          void clear(void);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_DONELIST_H */
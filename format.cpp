@@ -0,0 +1,286 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <triton/context.hpp>
+
+#include "format.hpp"
+#include "utils.hpp"
+
+using namespace triton;
+
+namespace {
+// a conversion specification, %[flags][width][.precision][length]conv
+struct spec_s {
+  char flags[6];
+  int nflags;
+  int width;
+  int prec;
+  char length; // 'H' hh, 'h', 'l' for every 64-bit modifier, 'L', 0
+  char conv;
+};
+
+// where the next argument comes from
+struct args_s {
+  Context *ctx;
+  int next;
+  int nextFloat;
+  int nextStack; // stack slots are shared by every class of argument
+
+  bool sysv() const {
+    return this->ctx->getArchitecture() == arch::ARCH_X86_64;
+  }
+
+  uint64 stack() { return getArg(this->ctx, ARG_REGS + this->nextStack++); }
+
+  uint64 integer() {
+    if (this->next < ARG_REGS)
+      return getArg(this->ctx, this->next++);
+    return this->stack();
+  }
+
+  double floating() {
+    uint64 bits;
+    if (this->sysv() && this->nextFloat < 8) {
+      auto id = static_cast<arch::register_e>(arch::ID_REG_X86_XMM0 +
+                                              this->nextFloat++);
+      bits = static_cast<uint64>(
+          this->ctx->getConcreteRegisterValue(this->ctx->getRegister(id)));
+    } else if (this->sysv()) {
+      bits = this->stack();
+    } else {
+      bits = this->integer();
+    }
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+  }
+
+  // long double, always on the stack in a 16-byte aligned x87 slot
+  long double extended() {
+    if (!this->sysv())
+      return this->floating();
+    this->nextStack += this->nextStack & 1;
+    auto addr = getArgAddr(this->ctx, ARG_REGS + this->nextStack);
+    this->nextStack += 2;
+    auto raw = this->ctx->getConcreteMemoryAreaValue(addr, 10);
+    uint64 mantissa;
+    uint16_t top;
+    std::memcpy(&mantissa, raw.data(), sizeof(mantissa));
+    std::memcpy(&top, raw.data() + 8, sizeof(top));
+    int exp = top & 0x7fff;
+    long double v;
+    if (exp == 0x7fff)
+      v = (mantissa << 1) ? std::numeric_limits<long double>::quiet_NaN()
+                          : std::numeric_limits<long double>::infinity();
+    else
+      v = std::ldexp(static_cast<long double>(mantissa),
+                     (exp ? exp : 1) - 16383 - 63);
+    return top & 0x8000 ? -v : v;
+  }
+};
+
+thread_local GuestReader fmtReader, strReader;
+
+// parse the specification after a '%', returns the index after it
+size_t parseSpec(std::string_view f, size_t i, spec_s &s, args_s &args) {
+  s.nflags = 0;
+  s.width = -1;
+  s.prec = -1;
+  s.length = 0;
+  s.conv = 0;
+
+  while (i < f.size() && std::strchr("-+ #0", f[i]) && s.nflags < 5)
+    s.flags[s.nflags++] = f[i++];
+  s.flags[s.nflags] = 0;
+
+  if (i < f.size() && f[i] == '*') {
+    s.width = static_cast<int>(args.integer());
+    i++;
+  } else {
+    for (; i < f.size() && f[i] >= '0' && f[i] <= '9'; i++)
+      s.width = (s.width < 0 ? 0 : s.width * 10) + (f[i] - '0');
+  }
+
+  if (i < f.size() && f[i] == '.') {
+    i++;
+    s.prec = 0;
+    if (i < f.size() && f[i] == '*') {
+      s.prec = static_cast<int>(args.integer());
+      i++;
+    } else {
+      for (; i < f.size() && f[i] >= '0' && f[i] <= '9'; i++)
+        s.prec = s.prec * 10 + (f[i] - '0');
+    }
+  }
+
+  for (; i < f.size() && std::strchr("hlLqjzt", f[i]); i++) {
+    if (f[i] == 'h')
+      s.length = s.length == 'h' ? 'H' : 'h';
+    else if (f[i] == 'L')
+      s.length = 'L';
+    else
+      s.length = 'l';
+  }
+
+  if (i < f.size())
+    s.conv = f[i++];
+  return i;
+}
+
+// printf one native value with the flags, width and precision of s
+template <typename T>
+void emit(std::string &out, const spec_s &s, const char *length, char conv,
+          T value) {
+  char native[32];
+  char tmp[128];
+  int n = 0;
+  n += std::snprintf(native + n, sizeof(native) - n, "%%%s", s.flags);
+  if (s.width >= 0)
+    n += std::snprintf(native + n, sizeof(native) - n, "%d", s.width);
+  if (s.prec >= 0)
+    n += std::snprintf(native + n, sizeof(native) - n, ".%d", s.prec);
+  std::snprintf(native + n, sizeof(native) - n, "%s%c", length, conv);
+
+  int len = std::snprintf(tmp, sizeof(tmp), native, value);
+  if (len < 0)
+    return;
+  if (static_cast<size_t>(len) < sizeof(tmp)) {
+    out.append(tmp, len);
+    return;
+  }
+  // wider than the stack buffer
+  size_t at = out.size();
+  out.resize(at + len + 1);
+  std::snprintf(&out[at], len + 1, native, value);
+  out.resize(at + len);
+}
+
+void pad(std::string &out, const spec_s &s, std::string_view str) {
+  size_t fill = s.width > 0 && static_cast<size_t>(s.width) > str.size()
+                    ? s.width - str.size()
+                    : 0;
+  bool left = std::memchr(s.flags, '-', s.nflags) != nullptr;
+  if (!left)
+    out.append(fill, ' ');
+  out.append(str);
+  if (left)
+    out.append(fill, ' ');
+}
+} // namespace
+
+uint64 formatGuest(Context *ctx, uint64 fmt, int first, std::string &out) {
+  auto f = fmtReader.cstring(ctx, fmt).data;
+  args_s args = {ctx, first, 0, 0};
+  size_t start = out.size();
+  spec_s s;
+
+  for (size_t i = 0; i < f.size();) {
+    // literal run up to the next conversion
+    auto pct = f.find('%', i);
+    if (pct == std::string_view::npos)
+      pct = f.size();
+    out.append(f.data() + i, pct - i);
+    if (pct == f.size())
+      break;
+
+    i = parseSpec(f, pct + 1, s, args);
+    switch (s.conv) {
+    case '%':
+      out += '%';
+      break;
+    case 'd':
+    case 'i': {
+      auto v = static_cast<int64_t>(args.integer());
+      if (s.length == 'H')
+        v = static_cast<signed char>(v);
+      else if (s.length == 'h')
+        v = static_cast<short>(v);
+      else if (s.length != 'l')
+        v = static_cast<int>(v);
+      emit(out, s, "ll", s.conv, static_cast<long long>(v));
+      break;
+    }
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o': {
+      auto v = args.integer();
+      if (s.length == 'H')
+        v = static_cast<unsigned char>(v);
+      else if (s.length == 'h')
+        v = static_cast<unsigned short>(v);
+      else if (s.length != 'l')
+        v = static_cast<unsigned int>(v);
+      emit(out, s, "ll", s.conv, static_cast<unsigned long long>(v));
+      break;
+    }
+    case 'c':
+      emit(out, s, "", 'c', static_cast<int>(static_cast<unsigned char>(
+                                 args.integer())));
+      break;
+    case 'p': {
+      auto v = args.integer();
+      if (v == 0)
+        pad(out, s, "(nil)");
+      else
+        emit(out, s, "", 'p', reinterpret_cast<void *>(v));
+      break;
+    }
+    case 's': {
+      auto ptr = args.integer();
+      if (ptr == 0) {
+        pad(out, s, s.prec < 0 || s.prec >= 6 ? "(null)" : "");
+        break;
+      }
+      auto max = s.prec < 0 ? UINT64_MAX : static_cast<uint64>(s.prec);
+      pad(out, s, strReader.cstring(ctx, ptr, max).data);
+      break;
+    }
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      if (s.length == 'L')
+        emit(out, s, "L", s.conv, args.extended());
+      else
+        emit(out, s, "", s.conv, args.floating());
+      break;
+    case 'n': {
+      auto ptr = args.integer();
+      uint64 count = out.size() - start;
+      uint64 size = s.length == 'H'   ? 1
+                    : s.length == 'h' ? 2
+                    : s.length == 'l' ? 8
+                                      : 4;
+      writeBytes(ctx, ptr, &count, size);
+      break;
+    }
+    default:
+      // unknown or truncated conversion, printed as is
+      out.append(f.data() + pct, i - pct);
+      break;
+    }
+  }
+
+  return out.size() - start;
+}
+
+uint64 printfArgAmount(std::string_view format) {
+  uint64 count = 0;
+  for (size_t i = 0; i < format.size(); i++) {
+    if (format[i] != '%')
+      continue;
+    if (i + 1 < format.size() && format[i + 1] == '%') {
+      i++;
+      continue;
+    }
+    count++;
+  }
+  return count;
+}
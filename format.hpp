@@ -0,0 +1,18 @@
+#ifndef KRACKME_FORMAT_H
+#define KRACKME_FORMAT_H
+
+#include <string>
+#include <string_view>
+#include <triton/context.hpp>
+
+using namespace triton;
+
+// Format the guest string at fmt like printf, the arguments are read with
+// getArg from number first on. Appends to out and returns the number of
+// characters appended.
+uint64 formatGuest(Context *ctx, uint64 fmt, int first, std::string &out);
+
+// Number of conversions of a format string, %% excluded.
+uint64 printfArgAmount(std::string_view format);
+
+#endif
@@ -0,0 +1,182 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <algorithm>
+
+#include "heap.hpp"
+#include "utils.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+GuestHeap::~GuestHeap() { this->detach(); }
+
+void GuestHeap::attach(triton::Context *ctx, bool redzones) {
+  this->detach();
+  this->ctx = ctx;
+  this->redzones = redzones;
+  this->cur = state_s();
+  this->saved = state_s();
+  this->errors = 0;
+}
+
+void GuestHeap::detach(void) { this->ctx = nullptr; }
+
+void GuestHeap::mark(void) { this->saved = this->cur; }
+
+void GuestHeap::reset(void) {
+  this->cur = this->saved;
+  this->errors = 0;
+}
+
+triton::uint32 GuestHeap::sizeClass(triton::uint64 size) {
+  triton::uint32 cls = 0;
+  for (triton::uint64 n = 16; n < size && cls < HEAP_CLASSES; n <<= 1) {
+    cls++;
+  }
+  return cls;
+}
+
+bool GuestHeap::intact(triton::uint64 addr, const chunk_s &chunk) {
+  auto below = readBytes(this->ctx, addr - HEAP_REDZONE, HEAP_REDZONE).data;
+  if (std::any_of(below.begin(), below.end(),
+                  [](char c) { return c != (char)HEAP_REDZONE_BYTE; }))
+    return false;
+  auto above = readBytes(this->ctx, addr + chunk.size, HEAP_REDZONE).data;
+  return std::all_of(above.begin(), above.end(),
+                     [](char c) { return c == (char)HEAP_REDZONE_BYTE; });
+}
+
+triton::uint64 GuestHeap::malloc(triton::uint64 size) {
+  /* Never fits, and the rounding below would wrap */
+  if (size > HEAP_SIZE)
+    return 0;
+
+  const triton::uint64 rz = this->redzones ? HEAP_REDZONE : 0;
+  const auto cls = GuestHeap::sizeClass(size);
+  triton::uint64 base = 0;
+  triton::uint64 bytes = 0;
+
+  if (cls < HEAP_CLASSES) {
+    /* Refill the class with a slab */
+    bytes = (16ull << cls) + 2 * rz;
+    auto &list = this->cur.free[cls];
+    if (list.empty()) {
+      const triton::uint64 slab = std::max(HEAP_SLAB, bytes);
+      if (this->cur.top + slab > HEAP_BASE + HEAP_SIZE)
+        return 0;
+      for (triton::uint64 off = slab / bytes * bytes; off >= bytes;
+           off -= bytes) {
+        list.push_back(this->cur.top + off - bytes);
+      }
+      this->cur.top += slab;
+    }
+    base = list.back();
+    list.pop_back();
+  } else {
+    /* Large chunks are page rounded, reuse the smallest fitting one */
+    bytes = (size + 2 * rz + 0xfff) & ~0xfffull;
+    auto it = this->cur.large.lower_bound(bytes);
+    if (it != this->cur.large.end()) {
+      bytes = it->first;
+      base = it->second;
+      this->cur.large.erase(it);
+    } else {
+      if (this->cur.top + bytes > HEAP_BASE + HEAP_SIZE)
+        return 0;
+      base = this->cur.top;
+      this->cur.top += bytes;
+    }
+  }
+
+  const triton::uint64 addr = base + rz;
+  const chunk_s chunk = {size, cls, bytes};
+  this->cur.live[addr] = chunk;
+
+  if (this->redzones) {
+    std::vector<triton::uint8> zone(HEAP_REDZONE, HEAP_REDZONE_BYTE);
+    this->ctx->setConcreteMemoryAreaValue(addr - HEAP_REDZONE, zone);
+    this->ctx->setConcreteMemoryAreaValue(addr + size, zone);
+  }
+  return addr;
+}
+
+triton::uint64 GuestHeap::calloc(triton::uint64 n, triton::uint64 size) {
+  if (size && n > HEAP_SIZE / size)
+    return 0;
+  auto addr = this->malloc(n * size);
+  if (addr) {
+    std::vector<triton::uint8> zero(n * size, 0);
+    this->ctx->setConcreteMemoryAreaValue(addr, zero);
+  }
+  return addr;
+}
+
+triton::uint64 GuestHeap::realloc(triton::uint64 addr, triton::uint64 size) {
+  if (addr == 0)
+    return this->malloc(size);
+
+  auto it = this->cur.live.find(addr);
+  if (it == this->cur.live.end()) {
+    this->errors++;
+    return 0;
+  }
+  if (size == 0) {
+    this->free(addr);
+    return 0;
+  }
+
+  /* The chunk is kept, as when the heap is exhausted */
+  if (size > HEAP_SIZE)
+    return 0;
+
+  const auto old = it->second.size;
+  auto dst = this->malloc(size);
+  if (dst) {
+    copyMemory(this->ctx, dst, addr, std::min(old, size));
+    this->free(addr);
+  }
+  return dst;
+}
+
+bool GuestHeap::free(triton::uint64 addr) {
+  if (addr == 0)
+    return true;
+
+  auto it = this->cur.live.find(addr);
+  if (it == this->cur.live.end()) {
+    this->errors++;
+    return false;
+  }
+
+  const auto chunk = it->second;
+  if (this->redzones && !this->intact(addr, chunk))
+    this->errors++;
+  this->cur.live.erase(it);
+
+  const triton::uint64 base = addr - (this->redzones ? HEAP_REDZONE : 0);
+  if (chunk.cls < HEAP_CLASSES)
+    this->cur.free[chunk.cls].push_back(base);
+  else
+    this->cur.large.emplace(chunk.bytes, base);
+  return true;
+}
+
+triton::usize GuestHeap::check(void) {
+  triton::usize damaged = 0;
+  if (this->redzones) {
+    for (const auto &item : this->cur.live) {
+      damaged += !this->intact(item.first, item.second);
+    }
+  }
+  return this->errors + damaged;
+}
+
+triton::usize GuestHeap::chunks(void) const { return this->cur.live.size(); }
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
@@ -0,0 +1,157 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_HEAP_H
+#define TRITON_HEAP_H
+
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <triton/context.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! First address of the guest heap.
+      constexpr triton::uint64 HEAP_BASE = 0xB0000000;
+
+      //! Size of the guest heap.
+      constexpr triton::uint64 HEAP_SIZE = 0x10000000;
+
+      //! Number of size classes, from 16 to 4096 bytes.
+      constexpr triton::usize HEAP_CLASSES = 9;
+
+      //! Bytes carved at once for a size class.
+      constexpr triton::uint64 HEAP_SLAB = 0x10000;
+
+      //! Size of a redzone, on each side of a chunk.
+      constexpr triton::uint64 HEAP_REDZONE = 16;
+
+      //! Value of the redzone bytes.
+      constexpr triton::uint8 HEAP_REDZONE_BYTE = 0xfa;
+
+      /*! \class GuestHeap
+          \brief malloc and free for the guest, on one context.
+
+          Small chunks come from per size class free lists refilled by
+          slabs, large ones are page rounded and reused first fit. The
+          bookkeeping lives on the host. mark() saves it and reset() rewinds
+          to it, so after the memory of a run is restored the heap is the
+          same as before the run. With redzones, each chunk is surrounded by
+          HEAP_REDZONE bytes of HEAP_REDZONE_BYTE, checked on free() and by
+          check(). */
+      class GuestHeap {
+        private:
+          //! A live chunk.
+          struct chunk_s {
+            triton::uint64 size;  //!< Requested size.
+            triton::uint32 cls;   //!< Size class, HEAP_CLASSES for a large chunk.
+            triton::uint64 bytes; //!< Size of the chunk, redzones included.
+          };
+
+          //! Everything reset() rewinds.
+          struct state_s {
+            //! First never used address.
+            triton::uint64 top = HEAP_BASE;
+
+            //! Free chunks of each size class.
+            std::vector<triton::uint64> free[HEAP_CLASSES];
+
+            //! Free large chunks: <size, base>
+            std::multimap<triton::uint64, triton::uint64> large;
+
+            //! Live chunks by user address.
+            std::unordered_map<triton::uint64, chunk_s> live;
+          };
+
+          //! The context.
+          triton::Context* ctx = nullptr;
+
+          //! True if chunks have redzones.
+          bool redzones = false;
+
+          //! Current state.
+          state_s cur;
+
+          //! State saved by mark().
+          state_s saved;
+
+          //! Bad frees and damaged redzones since the last reset().
+          triton::usize errors = 0;
+
+          //! Returns the size class of size, HEAP_CLASSES if it is large.
+          static triton::uint32 sizeClass(triton::uint64 size);
+
+          //! Returns true if the redzones of a chunk are intact.
+          bool intact(triton::uint64 addr, const chunk_s& chunk);
+
+        public:
+          //! Destructor.
+          ~GuestHeap();
+
+          //! Serve the allocations of ctx.
+          void attach(triton::Context* ctx, bool redzones);
+
+          //! Stop serving.
+          void detach(void);
+
+          //! Save the current state.
+          void mark(void);
+
+          //! Rewind to the saved state.
+          void reset(void);
+
+          //! Returns a chunk of size bytes, 0 if the heap is exhausted.
+          triton::uint64 malloc(triton::uint64 size);
+
+          //! Returns a zeroed chunk of n * size bytes.
+          triton::uint64 calloc(triton::uint64 n, triton::uint64 size);
+
+          //! Resize a chunk, its bytes (symbolic ones included) are kept.
+          triton::uint64 realloc(triton::uint64 addr, triton::uint64 size);
+
+          //! Release a chunk. Returns false on an invalid or double free.
+          bool free(triton::uint64 addr);
+
+          //! Check the redzones of the live chunks. Returns the number of errors since the last reset().
+          triton::usize check(void);
+
+          //! Number of live chunks.
+          triton::usize chunks(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_HEAP_H */
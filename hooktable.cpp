@@ -0,0 +1,101 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <chrono>
+#include <iomanip>
+
+#include "hooktable.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+void HookTable::add(triton::uint64 addr, const instCallback &cb, hook_e when,
+                    const std::string &name) {
+  for (auto &hook : this->hooks) {
+    if (hook->addr == addr) {
+      hook->cb[when] = cb;
+      if (hook->name.empty()) {
+        hook->name = name;
+      }
+      return;
+    }
+  }
+
+  auto hook = std::make_unique<Hook>();
+  hook->id = static_cast<triton::uint32>(this->hooks.size());
+  hook->addr = addr;
+  hook->name = name;
+  hook->cb[when] = cb;
+  this->hooks.push_back(std::move(hook));
+}
+
+void HookTable::build(void) {
+  /* At least twice as many slots as hooks, and one empty slot to stop the
+   * probes */
+  triton::usize size = 2;
+  triton::uint32 bits = 1;
+  while (size < this->hooks.size() * 2) {
+    size <<= 1;
+    bits++;
+  }
+  this->slots.assign(size, nullptr);
+  this->shift = 64 - bits;
+
+  this->lo = std::numeric_limits<triton::uint64>::max();
+  triton::uint64 hi = 0;
+  for (const auto &hook : this->hooks) {
+    this->lo = std::min(this->lo, hook->addr);
+    hi = std::max(hi, hook->addr);
+
+    auto i = this->slot(hook->addr);
+    while (this->slots[i] != nullptr) {
+      i = (i + 1) & (size - 1);
+    }
+    this->slots[i] = hook.get();
+  }
+  this->span = this->hooks.empty() ? 0 : hi - this->lo;
+}
+
+triton::callbacks::cb_state_e HookTable::call(Hook &hook, hook_e when,
+                                              triton::Context *ctx) {
+  auto start = std::chrono::steady_clock::now();
+  auto state = (*hook.cb[when])(ctx);
+  hook.time[when] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  hook.calls[when]++;
+  return state;
+}
+
+void HookTable::print(std::ostream &out) const {
+  for (const auto &hook : this->hooks) {
+    for (auto when : {HOOK_PRE, HOOK_POST}) {
+      const auto calls = hook->calls[when].load();
+      if (calls == 0) {
+        continue;
+      }
+      const auto time = hook->time[when].load();
+      out << "[TT] hook " << std::setw(20) << std::left
+          << (hook->name.empty() ? "-" : hook->name) << " 0x" << std::hex
+          << hook->addr << std::dec << (when == HOOK_PRE ? " pre " : " post ")
+          << calls << " calls, " << time / 1000 << "us, "
+          << time / calls << "ns/call" << std::endl;
+    }
+  }
+}
+
+std::vector<std::pair<triton::uint64, std::string>>
+HookTable::names(void) const {
+  std::vector<std::pair<triton::uint64, std::string>> out;
+  for (const auto &hook : this->hooks) {
+    out.emplace_back(hook->addr, hook->name);
+  }
+  return out;
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
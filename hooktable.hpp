@@ -0,0 +1,161 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_HOOKTABLE_H
+#define TRITON_HOOKTABLE_H
+
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <triton/comparableFunctor.hpp>
+#include <triton/context.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Callbacks namespace
+  namespace callbacks {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup callbacks
+   *  @{
+   */
+
+    //! State of callback
+    enum cb_state_e {
+      CONTINUE,
+      BREAK,
+      PLT_CONTINUE,
+    };
+
+  };
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Instruction callback signature
+      using instCallback = triton::ComparableFunctor<triton::callbacks::cb_state_e(triton::Context*)>;
+
+      //! When a hook runs.
+      enum hook_e {
+        HOOK_PRE,  //!< Before the instruction, instead of it.
+        HOOK_POST, //!< After the instruction (or the pre hook).
+      };
+
+      //! A hooked address.
+      struct Hook {
+        //! Id of the hook, its registration order.
+        triton::uint32 id;
+
+        //! Address of the hook.
+        triton::uint64 addr;
+
+        //! Name, for the stats.
+        std::string name;
+
+        //! Callbacks, by hook_e.
+        std::optional<instCallback> cb[2];
+
+        //! Number of calls, by hook_e.
+        std::atomic<triton::uint64> calls[2] = {};
+
+        //! Cumulated time of the calls (ns), by hook_e.
+        std::atomic<triton::uint64> time[2] = {};
+      };
+
+      /*! \class HookTable
+          \brief Instruction hooks, found in constant time.
+
+          Hooks are registered, then the table is built once before the
+          exploration. A lookup is a range check, which rejects the PCs of
+          the target, and a probe in an open addressing table half full at
+          most. */
+      class HookTable {
+        private:
+          //! Hooks, in registration order.
+          std::vector<std::unique_ptr<Hook>> hooks;
+
+          //! Open addressing table, size is a power of two.
+          std::vector<Hook*> slots;
+
+          //! Shift of the slot hash.
+          triton::uint32 shift = 64;
+
+          //! Lowest hooked address.
+          triton::uint64 lo = std::numeric_limits<triton::uint64>::max();
+
+          //! Highest hooked address minus lo.
+          triton::uint64 span = 0;
+
+          //! Slot of an address.
+          inline triton::usize slot(triton::uint64 addr) const {
+            return this->shift == 64 ? 0 : (addr * 0x9e3779b97f4a7c15) >> this->shift;
+          }
+
+        public:
+          //! Register a callback, replaces the previous one of the same address and kind.
+          void add(triton::uint64 addr, const instCallback& cb, hook_e when, const std::string& name);
+
+          //! Build the lookup table, call it after the last add().
+          void build(void);
+
+          //! Returns the hook of an address, nullptr if there is none.
+          inline Hook* find(triton::uint64 pc) const {
+            if (pc - this->lo > this->span) {
+              return nullptr;
+            }
+            const triton::usize mask = this->slots.size() - 1;
+            for (triton::usize i = this->slot(pc);; i = (i + 1) & mask) {
+              Hook* hook = this->slots[i];
+              if (hook == nullptr || hook->addr == pc) {
+                return hook;
+              }
+            }
+          }
+
+          //! Run a callback of a hook and account it.
+          triton::callbacks::cb_state_e call(Hook& hook, hook_e when, triton::Context* ctx);
+
+          //! Print the calls and time of each hook.
+          void print(std::ostream& out) const;
+
+          //! <address, name> of each hook, by id.
+          std::vector<std::pair<triton::uint64, std::string>> names(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_HOOKTABLE_H */
@@ -0,0 +1,87 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <triton/exceptions.hpp>
+#include <triton/solverModel.hpp>
+
+#include "incsolver.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+bool IncrementalSolver::isAvailable(void) {
+#ifdef TRITON_INCREMENTAL_SOLVER
+  return true;
+#else
+  return false;
+#endif
+}
+
+IncrementalSolver::IncrementalSolver(triton::usize timeout) {
+  this->timeout = static_cast<triton::uint32>(timeout * 1000);
+}
+
+void IncrementalSolver::assertion(const triton::ast::SharedAbstractNode &node) {
+  /* Converted lazily, a fully explored prefix never reaches the solver */
+  this->pending.push_back(node);
+}
+
+#ifdef TRITON_INCREMENTAL_SOLVER
+z3::solver &IncrementalSolver::getSolver(const z3::expr &expr) {
+  if (this->solver == nullptr) {
+    this->solver = std::make_unique<z3::solver>(expr.ctx());
+    if (this->timeout) {
+      z3::params p(expr.ctx());
+      p.set("timeout", this->timeout);
+      this->solver->set(p);
+    }
+  }
+  return *this->solver;
+}
+#endif
+
+triton::engines::solver::status_e
+IncrementalSolver::check(const triton::ast::SharedAbstractNode &node,
+                         triton::usize limit, Models &models) {
+#ifdef TRITON_INCREMENTAL_SOLVER
+  auto status = triton::engines::solver::UNSAT;
+  bool scoped = false;
+
+  try {
+    z3::expr expr = this->converter.convert(node);
+    z3::solver &solver = this->getSolver(expr);
+
+    /* Bring the prefix up to date */
+    for (const auto &pred : this->pending) {
+      solver.add(this->converter.convert(pred));
+    }
+    this->pending.clear();
+
+    solver.push();
+    scoped = true;
+    solver.add(expr);
+    status = SolverPool::enumerate(solver, this->converter, limit, models);
+    scoped = false;
+    solver.pop();
+  } catch (const z3::exception &) {
+    /* Never leave the branch asserted in the prefix */
+    if (scoped) {
+      this->solver->pop();
+    }
+    status = models.empty() ? triton::engines::solver::UNKNOWN
+                            : triton::engines::solver::SAT;
+  }
+
+  return status;
+#else
+  throw triton::exceptions::Engines(
+      "IncrementalSolver::check(): Z3 interface not available");
+#endif
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
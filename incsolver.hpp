@@ -0,0 +1,96 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_INCSOLVER_H
+#define TRITON_INCSOLVER_H
+
+
+#include <memory>
+#include <vector>
+
+#include <triton/ast.hpp>
+#include <triton/solverEnums.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include "solverpool.hpp"
+
+#ifdef TRITON_Z3_INTERFACE
+#define TRITON_INCREMENTAL_SOLVER
+#endif
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      /*! \class IncrementalSolver
+          \brief One Z3 solver instance kept along a trace.
+
+          The taken predicates are asserted once, when a query first needs
+          them, and each negated branch is checked inside a push/pop scope.
+          The solver thus keeps what it learnt about the prefix instead of
+          re-parsing the whole path predicate for every branch. Only
+          available when Triton exposes its Z3 interface. */
+      class IncrementalSolver {
+        private:
+#ifdef TRITON_INCREMENTAL_SOLVER
+          //! Triton to Z3 converter, owns the Z3 context.
+          triton::ast::TritonToZ3 converter;
+
+          //! The solver, created with the first expression.
+          std::unique_ptr<z3::solver> solver;
+
+          //! Returns the solver, creates it if needed.
+          z3::solver& getSolver(const z3::expr& expr);
+#endif
+
+          //! Taken predicates not asserted yet.
+          std::vector<triton::ast::SharedAbstractNode> pending;
+
+          //! Timeout of a check (ms).
+          triton::uint32 timeout;
+
+        public:
+          //! Returns true if incremental solving is compiled in.
+          static bool isAvailable(void);
+
+          //! Constructor. The timeout is in seconds.
+          IncrementalSolver(triton::usize timeout);
+
+          //! Add a taken predicate to the trace prefix.
+          void assertion(const triton::ast::SharedAbstractNode& node);
+
+          //! Check node under the prefix and enumerate up to limit models.
+          triton::engines::solver::status_e check(const triton::ast::SharedAbstractNode& node, triton::usize limit, Models& models);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_INCSOLVER_H */
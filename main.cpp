@@ -1,167 +1,53 @@
-#include <LIEF/ELF.hpp>
-#include <exception>
-#include <memory>
-#include <ostream>
-#include <stdexcept>
-#include <triton/archEnums.hpp>
-#include <triton/ast.hpp>
-#include <triton/callbacks.hpp>
-#include <triton/callbacksEnums.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
 #include <triton/context.hpp>
-#include <triton/cpuSize.hpp>
-#include <triton/exceptions.hpp>
-#include <triton/instruction.hpp>
-#include <triton/memoryAccess.hpp>
-#include <triton/modesEnums.hpp>
-#include <triton/register.hpp>
-#include <triton/stubs.hpp>
 
-#include "routines.hpp"
+#include "target.hpp"
 #include "ttexplore.hpp"
-#include "utils.hpp"
 
 using namespace triton;
 
 triton::Context gctx;
-bool DEBUG = false;
-std::unique_ptr<const LIEF::ELF::Binary> bin;
-
-#define RELOC_BASE 0x10000000
-#define STUB_BASE 0x11000000
-#define STACK_BASE 0x9FFFFFFF
-
-#define HANDLER(name)                                                          \
-  {                                                                            \
-#name, {                                                                   \
-      ROUTINE, RELOC_BASE + __COUNTER__ *size::dword, triton::routines::name   \
-    }                                                                          \
-  }
-// __COUNTER__ used to determine hook-function in callback
-#define STUB_HANDLER(name)                                                     \
-  {                                                                            \
-    #name, {                                                                   \
-      LIBC_STUB,                                                               \
-          triton::stubs::x8664::systemv::libc::symbols.at(#name) + STUB_BASE,  \
-          triton::routines::stub                                               \
-    }                                                                          \
-  }
-
-enum plt_type { ROUTINE = 0, LIBC_STUB, LIBC_CUSTOM };
-
-struct plt_info {
-  triton::uint8 type;
-  triton::uint64 addr;
-  triton::engines::exploration::instCallback cb;
-};
-
-// add relocation or symbol you would like to hook
-std::map<std::string, plt_info> custom_plt{HANDLER(__libc_start_main),
-                                           HANDLER(printf),
-                                           HANDLER(puts),
-                                           HANDLER(fflush),
-                                           HANDLER(getlogin),
-                                           HANDLER(usleep),
-                                           HANDLER(putchar),
-                                           HANDLER(exit),
-                                           STUB_HANDLER(strlen),
-                                           HANDLER(fgets)};
-
-void patchExection() {
-  for (const LIEF::Relocation rel : bin->relocations()) {
-    auto addr = rel.address();
-    auto symb = bin->get_relocation(addr)->symbol();
-    if (symb == nullptr)
-      continue;
-
-    auto name = symb->name();
-    auto check_hook = [=](std::pair<std::string, plt_info> i) {
-      return i.first == name;
-    };
-    auto hook = std::find_if(custom_plt.begin(), custom_plt.end(), check_hook);
-    if (hook == custom_plt.end())
-      continue;
-
-    triton_printf("[i] Replacing reloc %s\n", name.data());
-    arch::MemoryAccess mem(addr, gctx.getGprSize());
-    gctx.setConcreteMemoryValue(mem, hook->second.addr);
-  }
-  for (const LIEF::Symbol symb : bin->symbols()) {
-    auto addr = symb.value();
-    if (addr == 0)
-      continue;
-
-    auto name = symb.name();
-    auto check_hook = [=](std::pair<std::string, plt_info> i) {
-      return i.first == name;
-    };
-    auto hook = std::find_if(custom_plt.begin(), custom_plt.end(), check_hook);
-    if (hook == custom_plt.end())
-      continue;
-
-    triton_printf("[i] Replacing symb %s\n", name.data());
-    arch::MemoryAccess mem(addr, gctx.getGprSize());
-    gctx.setConcreteMemoryValue(mem, hook->second.addr);
-  }
-}
-
-uint64_t loadExec(std::string str) {
-  bin = LIEF::ELF::Parser::parse(str);
-  if (bin == nullptr)
-    throw std::invalid_argument("Cannot parse binary");
-
-  for (LIEF::Section sect : bin->sections()) {
-    uint64 addr = sect.virtual_address(); // + 0x400000; // for windows
-    uint64 size = sect.size();
-    auto mem = bin->get_content_from_virtual_address(addr, size);
-    triton_printf("[+] Mapping %#08zx-%#08zx\n", addr, addr + size);
-    gctx.setConcreteMemoryAreaValue(addr, mem);
-  }
-
-  gctx.setConcreteMemoryAreaValue(STUB_BASE,
-                                  triton::stubs::x8664::systemv::libc::code);
-  return bin->entrypoint();
-}
-
-void initTriton() {
-  gctx.setArchitecture(arch::ARCH_X86_64);
-  gctx.setMode(modes::ALIGNED_MEMORY, true);
-  gctx.setMode(modes::AST_OPTIMIZATIONS, true);
-  gctx.setMode(modes::CONSTANT_FOLDING, true);
-  // gctx.setMode(modes::MEMORY_ARRAY,
-  //              true); // use smt for bitvectors & array(another way only bv)
-     gctx.setMode(modes::ONLY_ON_SYMBOLIZED, true);
-  // gctx.setMode(modes::PC_TRACKING_SYMBOLIC, true);
-
-  gctx.setAstRepresentationMode(ast::representations::SMT_REPRESENTATION);
-
-  // setup fake stack regs
-  setGpr("sp", STACK_BASE);
-  setGpr("bp", STACK_BASE);
-}
-
-// add symbolic for memory
-void symbolize() {
-  gctx.symbolizeMemory(0x9fffff40, 0x32);
-}
 
 int main(int argc, char *argv[]) {
-  initTriton();
-
-  uint64 entrypoint =
-      loadExec("/home/l09/Work/CTF/20231220 Knight/krackme/krackme_1.out");
-  patchExection(); // bind our hooks
-
-  auto reg = gctx.getRegister(getGprId("ip"));
-  gctx.setConcreteRegisterValue(reg, entrypoint);
-  symbolize();
+  loadTarget(&gctx,
+             "/home/l09/Work/CTF/20231220 Knight/krackme/krackme_1.out");
 
   /* Setup exploration */
   engines::exploration::SymbolicExplorator explorator;
-
-  for (auto plt : custom_plt) {
-    if (plt.second.type == ROUTINE)
-      explorator.hookInstruction(plt.second.addr, plt.second.cb);
+  auto cores = std::max(2u, std::thread::hardware_concurrency());
+  explorator.config.workers = cores / 2;
+  explorator.config.solver_threads = cores - cores / 2;
+  explorator.config.checkpoint_interval = 60;
+  explorator.config.query_cache_persist = true;
+  explorator.config.target = KRACKME_SUCCESS;
+  for (int i = 1; i < argc; i++) {
+    explorator.config.resume |= std::string(argv[i]) == "--resume";
+    explorator.config.quiet |= std::string(argv[i]) == "--quiet";
+    explorator.config.trace |= std::string(argv[i]) == "--trace";
+    if (std::string(argv[i]).rfind("--target=", 0) == 0) {
+      explorator.config.target = std::stoull(argv[i] + 9, nullptr, 0);
+    }
+    if (std::string(argv[i]).rfind("--schedule=", 0) == 0 &&
+        !engines::exploration::Scheduler::parse(
+            argv[i] + 11, explorator.config.schedule)) {
+      std::cerr << "unknown schedule: " << argv[i] + 11 << std::endl;
+      return 1;
+    }
+    if (std::string(argv[i]).rfind("--ea=", 0) == 0 &&
+        !engines::exploration::EaConcretizer::parse(
+            argv[i] + 5, explorator.config.ea_strategy)) {
+      std::cerr << "unknown address strategy: " << argv[i] + 5 << std::endl;
+      return 1;
+    }
   }
+  /* The memory array is only rewound by full restores */
+  explorator.config.dirty_restore = explorator.config.ea_strategy !=
+                                    engines::exploration::EA_STRATEGY_ARRAY;
+
+  hookTarget(explorator);
 
   explorator.initContext(&gctx); /* define an initial context */
   explorator.explore();          /* do the exploration */
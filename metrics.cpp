@@ -0,0 +1,310 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+
+#include <triton/exceptions.hpp>
+
+#include "metrics.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+triton::uint64 Histogram::bound(triton::usize i) {
+  return static_cast<triton::uint64>(16) << i;
+}
+
+void Histogram::record(triton::uint64 us) {
+  triton::usize i = 0;
+  while (i < HISTOGRAM_BUCKETS && us > Histogram::bound(i)) {
+    i++;
+  }
+  this->buckets[i].fetch_add(1, std::memory_order_relaxed);
+  this->total.fetch_add(us, std::memory_order_relaxed);
+}
+
+triton::uint64 Histogram::bucket(triton::usize i) const {
+  return this->buckets[i].load(std::memory_order_relaxed);
+}
+
+triton::uint64 Histogram::count(void) const {
+  triton::uint64 n = 0;
+  for (const auto &b : this->buckets) {
+    n += b.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+triton::uint64 Histogram::sum(void) const {
+  return this->total.load(std::memory_order_relaxed);
+}
+
+const char *Metrics::name(phase_e phase) {
+  switch (phase) {
+  case PHASE_RUN:
+    return "run";
+  case PHASE_FIND_INPUTS:
+    return "find_inputs";
+  case PHASE_SYMBOLIZE_EA:
+    return "symbolize_ea";
+  case PHASE_SNAPSHOT:
+    return "snapshot";
+  case PHASE_RESTORE:
+    return "restore";
+  default:
+    return "unknown";
+  }
+}
+
+const char *Metrics::name(answer_e answer) {
+  switch (answer) {
+  case ANSWER_SAT:
+    return "sat";
+  case ANSWER_UNSAT:
+    return "unsat";
+  case ANSWER_TIMEOUT:
+    return "timeout";
+  default:
+    return "unknown";
+  }
+}
+
+const char *Metrics::name(answer_source_e source) {
+  switch (source) {
+  case SOURCE_SOLVER:
+    return "solver";
+  case SOURCE_CACHE:
+    return "cache";
+  case SOURCE_REUSE:
+    return "reuse";
+  case SOURCE_PROBES:
+    return "probes";
+  default:
+    return "unknown";
+  }
+}
+
+void Metrics::open(const std::string &dir, triton::usize interval) {
+  this->close();
+  this->dir = dir;
+  this->interval = static_cast<triton::sint64>(interval) * 1000;
+  this->start = std::chrono::steady_clock::now();
+  this->last = 0;
+  this->prevTime = 0;
+  this->prevExecs = 0;
+  this->prevInstructions = 0;
+
+  std::filesystem::create_directories(dir);
+  this->history.open(dir + "/" + METRICS_JSON_FILE, std::ios::app);
+  if (!this->history) {
+    throw triton::exceptions::Engines("Metrics::open(): Cannot open " + dir +
+                                      "/" + METRICS_JSON_FILE + ".");
+  }
+}
+
+void Metrics::close(void) {
+  if (this->history.is_open()) {
+    this->history.close();
+  }
+}
+
+void Metrics::solved(triton::engines::solver::status_e status,
+                     triton::uint64 us) {
+  /* Same split as the sat/unsat/timeout counters */
+  if (status == triton::engines::solver::SAT) {
+    this->latency[ANSWER_SAT].record(us);
+  } else if (status == triton::engines::solver::TIMEOUT) {
+    this->latency[ANSWER_TIMEOUT].record(us);
+  } else {
+    this->latency[ANSWER_UNSAT].record(us);
+  }
+}
+
+void Metrics::concretized(ea_strategy_e strategy, triton::uint64 seeds,
+                          triton::uint64 us) {
+  this->eaCalls[strategy].fetch_add(1, std::memory_order_relaxed);
+  this->eaSeeds[strategy].fetch_add(seeds, std::memory_order_relaxed);
+  this->eaTime[strategy].fetch_add(us, std::memory_order_relaxed);
+}
+
+triton::uint64 Metrics::seeds(ea_strategy_e strategy) const {
+  return this->eaSeeds[strategy].load(std::memory_order_relaxed);
+}
+
+triton::uint64 Metrics::average(phase_e phase) const {
+  const auto calls = this->phaseCalls[phase].load(std::memory_order_relaxed);
+  return calls ? this->phaseTime[phase].load(std::memory_order_relaxed) / calls
+               : 0;
+}
+
+triton::uint64 Metrics::total(phase_e phase) const {
+  return this->phaseTime[phase].load(std::memory_order_relaxed);
+}
+
+bool Metrics::due(void) {
+  const triton::sint64 now =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - this->start)
+          .count();
+  auto last = this->last.load();
+  return now - last >= this->interval &&
+         this->last.compare_exchange_strong(last, now);
+}
+
+void Metrics::write(const MetricsSample &s) {
+  std::lock_guard<std::mutex> guard(this->lock);
+
+  const triton::sint64 now =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - this->start)
+          .count();
+  const auto insts = this->instructions.load(std::memory_order_relaxed);
+
+  /* Rates over the last interval */
+  const double span = (now - this->prevTime) / 1000.0;
+  const double execRate =
+      span > 0 ? (s.execs - this->prevExecs) / span : 0.0;
+  const double instRate =
+      span > 0 ? (insts - this->prevInstructions) / span : 0.0;
+  this->prevTime = now;
+  this->prevExecs = s.execs;
+  this->prevInstructions = insts;
+
+  if (this->history.is_open()) {
+    auto &out = this->history;
+    out << std::fixed << std::setprecision(3) << "{\"time\":" << now / 1000.0
+        << ",\"execs\":" << s.execs << ",\"execs_per_sec\":" << execRate
+        << ",\"instructions\":" << insts << ",\"inst_per_sec\":" << instRate
+        << ",\"sat\":" << s.sat << ",\"unsat\":" << s.unsat
+        << ",\"timeout\":" << s.timeout << ",\"worklist\":" << s.worklist
+        << ",\"squeue\":" << s.squeue << ",\"icov\":" << s.icov
+        << ",\"ecov\":" << s.ecov << ",\"phases\":{";
+    for (triton::usize p = 0; p < PHASE_COUNT; p++) {
+      out << (p ? "," : "") << "\"" << Metrics::name(static_cast<phase_e>(p))
+          << "\":{\"calls\":" << this->phaseCalls[p].load()
+          << ",\"seconds\":" << this->phaseTime[p].load() / 1e9 << "}";
+    }
+    out << "},\"solver\":{";
+    for (triton::usize a = 0; a < ANSWER_COUNT; a++) {
+      const auto &h = this->latency[a];
+      out << (a ? "," : "") << "\""
+          << Metrics::name(static_cast<answer_e>(a))
+          << "\":{\"count\":" << h.count() << ",\"sum_us\":" << h.sum()
+          << ",\"buckets\":[";
+      for (triton::usize i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+        out << (i ? "," : "") << h.bucket(i);
+      }
+      out << "]}";
+    }
+    out << "},\"answers\":{";
+    for (triton::usize a = 0; a < SOURCE_COUNT; a++) {
+      out << (a ? "," : "") << "\""
+          << Metrics::name(static_cast<answer_source_e>(a))
+          << "\":" << this->sources[a].load();
+    }
+    out << "},\"ea\":{";
+    for (triton::usize e = 0; e < EA_STRATEGY_COUNT; e++) {
+      out << (e ? "," : "") << "\""
+          << EaConcretizer::name(static_cast<ea_strategy_e>(e))
+          << "\":{\"calls\":" << this->eaCalls[e].load()
+          << ",\"seeds\":" << this->eaSeeds[e].load()
+          << ",\"solver_seconds\":" << this->eaTime[e].load() / 1e6 << "}";
+    }
+    out << "}}" << std::endl;
+  }
+
+  this->writeProm(s, execRate, instRate);
+}
+
+void Metrics::writeProm(const MetricsSample &s, double execRate,
+                        double instRate) {
+  /* Scrapers never see a half written file */
+  const auto path = this->dir + "/" + METRICS_PROM_FILE;
+  const auto tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) {
+      return;
+    }
+    auto counter = [&](const char *name, triton::uint64 value) {
+      out << "# TYPE ttexplore_" << name << " counter\n"
+          << "ttexplore_" << name << " " << value << "\n";
+    };
+    auto gauge = [&](const char *name, double value) {
+      out << "# TYPE ttexplore_" << name << " gauge\n"
+          << "ttexplore_" << name << " " << value << "\n";
+    };
+
+    out << std::fixed << std::setprecision(6);
+    counter("execs_total", s.execs);
+    counter("instructions_total", this->instructions.load());
+    counter("sat_total", s.sat);
+    counter("unsat_total", s.unsat);
+    counter("timeout_total", s.timeout);
+    gauge("execs_per_second", execRate);
+    gauge("instructions_per_second", instRate);
+    gauge("worklist_depth", s.worklist);
+    gauge("solver_queue_depth", s.squeue);
+    gauge("instruction_coverage", s.icov);
+    gauge("edge_coverage", s.ecov);
+
+    out << "# TYPE ttexplore_phase_seconds_total counter\n";
+    for (triton::usize p = 0; p < PHASE_COUNT; p++) {
+      out << "ttexplore_phase_seconds_total{phase=\""
+          << Metrics::name(static_cast<phase_e>(p)) << "\"} "
+          << this->phaseTime[p].load() / 1e9 << "\n";
+    }
+
+    out << "# TYPE ttexplore_solver_latency_seconds histogram\n";
+    for (triton::usize a = 0; a < ANSWER_COUNT; a++) {
+      const auto &h = this->latency[a];
+      const auto status = Metrics::name(static_cast<answer_e>(a));
+      triton::uint64 cumulated = 0;
+      for (triton::usize i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+        cumulated += h.bucket(i);
+        out << "ttexplore_solver_latency_seconds_bucket{status=\"" << status
+            << "\",le=\"";
+        if (i == HISTOGRAM_BUCKETS) {
+          out << "+Inf";
+        } else {
+          out << Histogram::bound(i) / 1e6;
+        }
+        out << "\"} " << cumulated << "\n";
+      }
+      out << "ttexplore_solver_latency_seconds_sum{status=\"" << status
+          << "\"} " << h.sum() / 1e6 << "\n"
+          << "ttexplore_solver_latency_seconds_count{status=\"" << status
+          << "\"} " << cumulated << "\n";
+    }
+
+    out << "# TYPE ttexplore_answers_total counter\n";
+    for (triton::usize a = 0; a < SOURCE_COUNT; a++) {
+      out << "ttexplore_answers_total{source=\""
+          << Metrics::name(static_cast<answer_source_e>(a)) << "\"} "
+          << this->sources[a].load() << "\n";
+    }
+
+    out << "# TYPE ttexplore_ea_seeds_total counter\n";
+    for (triton::usize e = 0; e < EA_STRATEGY_COUNT; e++) {
+      out << "ttexplore_ea_seeds_total{strategy=\""
+          << EaConcretizer::name(static_cast<ea_strategy_e>(e)) << "\"} "
+          << this->eaSeeds[e].load() << "\n";
+    }
+    out << "# TYPE ttexplore_ea_solver_seconds_total counter\n";
+    for (triton::usize e = 0; e < EA_STRATEGY_COUNT; e++) {
+      out << "ttexplore_ea_solver_seconds_total{strategy=\""
+          << EaConcretizer::name(static_cast<ea_strategy_e>(e)) << "\"} "
+          << this->eaTime[e].load() / 1e6 << "\n";
+    }
+  }
+  std::rename(tmp.c_str(), path.c_str());
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
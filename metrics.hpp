@@ -0,0 +1,247 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_METRICS_H
+#define TRITON_METRICS_H
+
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include <triton/solverEnums.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include "concretize.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Name of the JSON-lines history in the stats directory.
+      constexpr const char* METRICS_JSON_FILE = "metrics.jsonl";
+
+      //! Name of the Prometheus text file in the stats directory.
+      constexpr const char* METRICS_PROM_FILE = "metrics.prom";
+
+      //! Latency buckets, bucket i holds up to 16us << i, plus one unbounded.
+      constexpr triton::usize HISTOGRAM_BUCKETS = 20;
+
+      //! Timed phases of an execution. They nest: symbolize_ea is part of run.
+      enum phase_e {
+        PHASE_RUN = 0,
+        PHASE_FIND_INPUTS,
+        PHASE_SYMBOLIZE_EA,
+        PHASE_SNAPSHOT,
+        PHASE_RESTORE,
+        PHASE_COUNT,
+      };
+
+      //! Solver answers with a latency histogram.
+      enum answer_e {
+        ANSWER_SAT = 0,
+        ANSWER_UNSAT,
+        ANSWER_TIMEOUT,
+        ANSWER_COUNT,
+      };
+
+      //! Where an answer merged into the worklist comes from.
+      enum answer_source_e {
+        SOURCE_SOLVER = 0, /* one timed solver call */
+        SOURCE_CACHE,      /* the query cache */
+        SOURCE_REUSE,      /* a known seed satisfied the query */
+        SOURCE_PROBES,     /* several solver calls, the range of an address */
+        SOURCE_COUNT,
+      };
+
+      //! Exponential latency histogram, in microseconds.
+      class Histogram {
+        private:
+          //! Samples by bucket, the last one is unbounded.
+          std::atomic<triton::uint64> buckets[HISTOGRAM_BUCKETS + 1] = {};
+
+          //! Sum of the samples.
+          std::atomic<triton::uint64> total{0};
+
+        public:
+          //! Upper bound of a bucket (us).
+          static triton::uint64 bound(triton::usize i);
+
+          //! Record a sample.
+          void record(triton::uint64 us);
+
+          //! Samples of a bucket.
+          triton::uint64 bucket(triton::usize i) const;
+
+          //! Number of samples.
+          triton::uint64 count(void) const;
+
+          //! Sum of the samples (us).
+          triton::uint64 sum(void) const;
+      };
+
+      //! Counters of the explorator sampled at each report.
+      struct MetricsSample {
+        triton::uint64 execs;
+        triton::uint64 sat;
+        triton::uint64 unsat;
+        triton::uint64 timeout;
+        triton::uint64 worklist;
+        triton::uint64 icov;
+        triton::uint64 ecov;
+        triton::uint64 squeue;
+      };
+
+      /*! \class Metrics
+          \brief Rates, phase timings and solver latencies of the exploration.
+
+          The hot paths only bump atomics. Reports are rate limited: one
+          thread at a time wins due() and appends a line to the JSON-lines
+          history and rewrites the Prometheus file. */
+      class Metrics {
+        private:
+          //! Cumulated time (ns) by phase_e.
+          std::atomic<triton::uint64> phaseTime[PHASE_COUNT] = {};
+
+          //! Number of timed sections by phase_e.
+          std::atomic<triton::uint64> phaseCalls[PHASE_COUNT] = {};
+
+          //! Solver latencies by answer_e.
+          Histogram latency[ANSWER_COUNT];
+
+          //! Merged answers by answer_source_e.
+          std::atomic<triton::uint64> sources[SOURCE_COUNT] = {};
+
+          //! Concretized addresses by ea_strategy_e.
+          std::atomic<triton::uint64> eaCalls[EA_STRATEGY_COUNT] = {};
+
+          //! Seeds generated by ea_strategy_e.
+          std::atomic<triton::uint64> eaSeeds[EA_STRATEGY_COUNT] = {};
+
+          //! Solver time (us) by ea_strategy_e.
+          std::atomic<triton::uint64> eaTime[EA_STRATEGY_COUNT] = {};
+
+          //! Executed instructions.
+          std::atomic<triton::uint64> instructions{0};
+
+          //! Start of the exploration.
+          std::chrono::steady_clock::time_point start;
+
+          //! Time of the last report (ms since start).
+          std::atomic<triton::sint64> last{0};
+
+          //! Milliseconds between two reports.
+          triton::sint64 interval = 1000;
+
+          //! Directory of the files.
+          std::string dir;
+
+          //! Serializes the reports.
+          std::mutex lock;
+
+          //! JSON-lines history.
+          std::ofstream history;
+
+          //! Counters of the previous report, for the rates.
+          triton::sint64 prevTime = 0;
+          triton::uint64 prevExecs = 0;
+          triton::uint64 prevInstructions = 0;
+
+          //! Rewrite the Prometheus file.
+          void writeProm(const MetricsSample& s, double execRate, double instRate);
+
+        public:
+          //! Name of a phase.
+          static const char* name(phase_e phase);
+
+          //! Name of an answer.
+          static const char* name(answer_e answer);
+
+          //! Name of an answer source.
+          static const char* name(answer_source_e source);
+
+          //! Start the clock and open the files in dir, reporting every interval seconds.
+          void open(const std::string& dir, triton::usize interval);
+
+          //! Close the files.
+          void close(void);
+
+          //! Account the time of a phase.
+          inline void add(phase_e phase, std::chrono::steady_clock::time_point since) {
+            this->phaseTime[phase].fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count(),
+                std::memory_order_relaxed);
+            this->phaseCalls[phase].fetch_add(1, std::memory_order_relaxed);
+          }
+
+          //! Account calls of a phase that took ns nanoseconds in total.
+          inline void add(phase_e phase, triton::uint64 ns, triton::uint64 calls) {
+            this->phaseTime[phase].fetch_add(ns, std::memory_order_relaxed);
+            this->phaseCalls[phase].fetch_add(calls, std::memory_order_relaxed);
+          }
+
+          //! Account executed instructions.
+          inline void executed(triton::uint64 count) {
+            this->instructions.fetch_add(count, std::memory_order_relaxed);
+          }
+
+          //! Account a merged answer.
+          inline void answered(answer_source_e source) {
+            this->sources[source].fetch_add(1, std::memory_order_relaxed);
+          }
+
+          //! Account a solver answer that took us microseconds.
+          void solved(triton::engines::solver::status_e status, triton::uint64 us);
+
+          //! Account a concretized address, its seeds and solver time (us).
+          void concretized(ea_strategy_e strategy, triton::uint64 seeds, triton::uint64 us);
+
+          //! Seeds generated by a strategy.
+          triton::uint64 seeds(ea_strategy_e strategy) const;
+
+          //! Average time of a phase (ns), 0 if never timed.
+          triton::uint64 average(phase_e phase) const;
+
+          //! Cumulated time of a phase (ns).
+          triton::uint64 total(phase_e phase) const;
+
+          //! True for the one caller that should report now.
+          bool due(void);
+
+          //! Write a report.
+          void write(const MetricsSample& s);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_METRICS_H */
@@ -0,0 +1,22 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include "output.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+void OutputCapture::write(const char *data, triton::usize size) {
+  this->buffer.append(data, size);
+}
+
+void OutputCapture::clear(void) { this->buffer.clear(); }
+
+const std::string &OutputCapture::data(void) const { return this->buffer; }
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
@@ -0,0 +1,67 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_OUTPUT_H
+#define TRITON_OUTPUT_H
+
+
+#include <string>
+
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      /*! \class OutputCapture
+          \brief What the guest prints during one execution of a worker.
+
+          The routines write to the capture of the worker running them, and
+          to the host stdout outside of the exploration. */
+      class OutputCapture {
+        private:
+          //! Output of the current execution.
+          std::string buffer;
+
+        public:
+          //! Append guest output.
+          void write(const char* data, triton::usize size);
+
+          //! Drop the captured output.
+          void clear(void);
+
+          //! Captured output.
+          const std::string& data(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_OUTPUT_H */
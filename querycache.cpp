@@ -0,0 +1,578 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+#include <triton/coreUtils.hpp>
+#include <triton/exceptions.hpp>
+#include <triton/solverModel.hpp>
+
+#include "querycache.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+/* Little helpers over a byte buffer, values are stored in host order */
+template <typename T> static void put(std::vector<char> &out, const T &v) {
+  const char *p = reinterpret_cast<const char *>(&v);
+  out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static void get(const std::vector<char> &in, triton::usize &pos, T &v) {
+  if (pos + sizeof(T) > in.size()) {
+    throw triton::exceptions::Engines(
+        "QueryCache::load(): Truncated query cache.");
+  }
+  std::memcpy(&v, in.data() + pos, sizeof(T));
+  pos += sizeof(T);
+}
+
+template <typename T> static void put(std::string &out, const T &v) {
+  out.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+/* FNV-1a of a form */
+static triton::uint64 digest(const std::string &form) {
+  triton::uint64 h = 0xcbf29ce484222325 ^ form.size();
+  for (unsigned char c : form) {
+    h = (h ^ c) * 0x100000001b3;
+  }
+  return h;
+}
+
+/* Operands of a node, a reference stands for its expression */
+static std::vector<triton::ast::SharedAbstractNode>
+operands(triton::ast::AbstractNode *node) {
+  if (node->getType() == triton::ast::REFERENCE_NODE) {
+    return {static_cast<triton::ast::ReferenceNode *>(node)
+                ->getSymbolicExpression()
+                ->getAst()};
+  }
+  return node->getChildren();
+}
+
+std::string QueryCache::form(const triton::ast::SharedAbstractNode &node) {
+  /* The DAG in post order, each node once: type, size, payload and the
+   * indexes of its operands. Unlike getHash(), the order of the operands
+   * matters, bvsub(x, y) and bvsub(y, x) differ. */
+  std::string out;
+  std::unordered_map<const triton::ast::AbstractNode *, triton::uint32> index;
+  std::vector<std::pair<triton::ast::AbstractNode *, bool>> stack{
+      {node.get(), false}};
+
+  while (!stack.empty()) {
+    auto [n, expanded] = stack.back();
+    if (index.count(n)) {
+      stack.pop_back();
+      continue;
+    }
+    const auto inputs = operands(n);
+    if (!expanded) {
+      stack.back().second = true;
+      for (auto it = inputs.rbegin(); it != inputs.rend(); it++) {
+        if (index.count(it->get()) == 0) {
+          stack.emplace_back(it->get(), false);
+        }
+      }
+      continue;
+    }
+    stack.pop_back();
+
+    if (n->getType() == triton::ast::REFERENCE_NODE) {
+      index[n] = index.at(inputs.front().get());
+      continue;
+    }
+    put<triton::uint32>(out, n->getType());
+    put<triton::uint32>(out, n->getBitvectorSize());
+    switch (n->getType()) {
+    case triton::ast::INTEGER_NODE: {
+      auto value = static_cast<triton::ast::IntegerNode *>(n)->getInteger();
+      for (; value != 0; value >>= 64) {
+        put(out, triton::utils::cast<triton::uint64>(value));
+      }
+      break;
+    }
+    case triton::ast::VARIABLE_NODE:
+      put<triton::uint64>(out, static_cast<triton::ast::VariableNode *>(n)
+                                   ->getSymbolicVariable()
+                                   ->getId());
+      break;
+    case triton::ast::STRING_NODE: {
+      const auto str = static_cast<triton::ast::StringNode *>(n)->getString();
+      put<triton::uint64>(out, str.size());
+      out += str;
+      break;
+    }
+    default:
+      break;
+    }
+    put<triton::uint32>(out, inputs.size());
+    for (const auto &input : inputs) {
+      put(out, index.at(input.get()));
+    }
+    const auto id = static_cast<triton::uint32>(index.size());
+    index[n] = id;
+  }
+  return out;
+}
+
+void QueryCache::conjuncts(const triton::ast::SharedAbstractNode &node,
+                           std::vector<QueryConjunct> &out) {
+  std::vector<triton::ast::SharedAbstractNode> stack{node};
+  while (!stack.empty()) {
+    auto n = std::move(stack.back());
+    stack.pop_back();
+    if (n->getType() == triton::ast::LAND_NODE) {
+      for (const auto &child : n->getChildren()) {
+        stack.push_back(child);
+      }
+    } else if (n->isSymbolized() || n->evaluate() == 0) {
+      auto f = std::make_shared<const std::string>(QueryCache::form(n));
+      const auto h = digest(*f);
+      out.push_back(QueryConjunct{h, std::move(f)});
+    }
+  }
+}
+
+/* Forms are shared once cached, most comparisons are pointer ones */
+static bool sameForm(const QueryForm &a, const QueryForm &b) {
+  return a == b || *a == *b;
+}
+
+static bool byHash(const QueryConjunct &a, const QueryConjunct &b) {
+  return a.hash < b.hash;
+}
+
+void QueryPrefix::add(const triton::ast::SharedAbstractNode &node) {
+  std::vector<QueryConjunct> added;
+  QueryCache::conjuncts(node, added);
+  for (auto &c : added) {
+    auto it = std::lower_bound(this->conjuncts.begin(), this->conjuncts.end(),
+                               c, byHash);
+    if (it != this->conjuncts.end() && it->hash == c.hash) {
+      this->valid = this->valid && sameForm(it->form, c.form);
+      continue;
+    }
+    this->conjuncts.insert(it, std::move(c));
+  }
+}
+
+QueryKey QueryPrefix::key(const triton::ast::SharedAbstractNode &node) const {
+  std::vector<QueryConjunct> added;
+  QueryCache::conjuncts(node, added);
+  std::sort(added.begin(), added.end(), byHash);
+
+  /* Merge the sorted prefix and the conjuncts of node. Same conjunct once,
+   * two different conjuncts with the same hash cannot be told apart by the
+   * cache. */
+  QueryKey key;
+  key.valid = this->valid;
+  key.conjuncts.reserve(this->conjuncts.size() + added.size());
+  key.forms.reserve(this->conjuncts.size() + added.size());
+  auto push = [&key](const QueryConjunct &c) {
+    if (!key.conjuncts.empty() && key.conjuncts.back() == c.hash) {
+      key.valid = key.valid && sameForm(key.forms.back(), c.form);
+      return;
+    }
+    key.conjuncts.push_back(c.hash);
+    key.forms.push_back(c.form);
+  };
+  auto a = this->conjuncts.begin();
+  auto b = added.begin();
+  while (a != this->conjuncts.end() || b != added.end()) {
+    if (b == added.end() ||
+        (a != this->conjuncts.end() && a->hash <= b->hash)) {
+      push(*a++);
+    } else {
+      push(*b++);
+    }
+  }
+
+  /* FNV-1a over the sorted conjuncts, with their number folded in */
+  key.hash = 0xcbf29ce484222325 ^ key.conjuncts.size();
+  for (auto c : key.conjuncts) {
+    key.hash = (key.hash ^ c) * 0x100000001b3;
+  }
+  return key;
+}
+
+QueryKey QueryCache::key(const triton::ast::SharedAbstractNode &node) {
+  return QueryPrefix().key(node);
+}
+
+void QueryCache::reset(triton::usize capacity) {
+  std::unique_lock<std::shared_mutex> guard(this->lock);
+  this->answers.clear();
+  this->unsat.clear();
+  this->forms.clear();
+  this->clock.clear();
+  this->referenced.clear();
+  this->hand = 0;
+  this->capacity = capacity;
+  this->nbHits = 0;
+  this->nbSubsumed = 0;
+  this->nbMisses = 0;
+  this->nbEvicted = 0;
+}
+
+bool QueryCache::enabled(void) const { return this->capacity != 0; }
+
+bool QueryCache::lookup(
+    const QueryKey &key, triton::usize limit,
+    const std::vector<triton::engines::symbolic::SharedSymbolicVariable> &vars,
+    triton::engines::solver::status_e &status, Models &models,
+    const std::function<bool(const Models &)> &check) {
+  if (!key.valid) {
+    this->nbMisses++;
+    return false;
+  }
+
+  bool exact = false;
+  {
+    std::shared_lock<std::shared_mutex> guard(this->lock);
+
+    /* Same query, with enough models */
+    auto it = this->answers.find(key.hash);
+    if (it != this->answers.end() && it->second.conjuncts == key.conjuncts &&
+        this->matchLocked(key, it->second.conjuncts)) {
+      const auto &answer = it->second;
+      if (answer.status != triton::engines::solver::SAT ||
+          answer.limit >= limit || answer.models.size() < answer.limit) {
+        this->referenced[answer.slot] = true;
+        status = answer.status;
+        models.clear();
+        for (const auto &m : answer.models) {
+          if (models.size() == limit) {
+            break;
+          }
+          models.emplace_back();
+          for (const auto &item : m) {
+            if (item.first < vars.size()) {
+              models.back()[item.first] =
+                  triton::engines::solver::SolverModel(vars[item.first],
+                                                       item.second);
+            }
+          }
+        }
+        exact = true;
+      }
+    }
+
+    /* A cached UNSAT query whose conjuncts are all in this one */
+    if (!exact) {
+      for (auto c : key.conjuncts) {
+        auto candidates = this->unsat.find(c);
+        if (candidates == this->unsat.end()) {
+          continue;
+        }
+        for (auto hash : candidates->second) {
+          const auto &answer = this->answers.at(hash);
+          if (answer.conjuncts.size() <= key.conjuncts.size() &&
+              answer.status == triton::engines::solver::UNSAT &&
+              this->matchLocked(key, answer.conjuncts)) {
+            this->referenced[answer.slot] = true;
+            status = triton::engines::solver::UNSAT;
+            models.clear();
+            this->nbSubsumed++;
+            return true;
+          }
+        }
+      }
+      this->nbMisses++;
+      return false;
+    }
+  }
+
+  /* The models must still satisfy the query, out of the lock */
+  if (status == triton::engines::solver::SAT && !check(models)) {
+    models.clear();
+    this->nbMisses++;
+    return false;
+  }
+  this->nbHits++;
+  return true;
+}
+
+bool QueryCache::matchLocked(const QueryKey &key,
+                             const std::vector<triton::uint64> &core) const {
+  /* Both are sorted */
+  triton::usize j = 0;
+  for (auto c : core) {
+    while (j < key.conjuncts.size() && key.conjuncts[j] < c) {
+      j++;
+    }
+    if (j == key.conjuncts.size() || key.conjuncts[j] != c) {
+      return false;
+    }
+    auto f = this->forms.find(c);
+    if (f == this->forms.end() || !sameForm(f->second.form, key.forms[j])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void QueryCache::insert(const QueryKey &key, triton::usize limit,
+                        triton::engines::solver::status_e status,
+                        const Models &models) {
+  /* A timeout says nothing about the query, a model wider than 64 bits does
+   * not fit */
+  if (!key.valid || (status != triton::engines::solver::SAT &&
+                     status != triton::engines::solver::UNSAT)) {
+    return;
+  }
+
+  QueryAnswer answer;
+  answer.status = status;
+  answer.limit = limit;
+  answer.conjuncts = key.conjuncts;
+  for (const auto &model : models) {
+    answer.models.emplace_back();
+    for (const auto &item : model) {
+      if (item.second.getVariable()->getSize() > 64) {
+        return;
+      }
+      answer.models.back().emplace_back(
+          item.first,
+          triton::utils::cast<triton::uint64>(item.second.getValue()));
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> guard(this->lock);
+  this->insertLocked(key.hash, std::move(answer), key.forms);
+}
+
+bool QueryCache::insertLocked(triton::uint64 hash, QueryAnswer &&answer,
+                              const std::vector<QueryForm> &forms) {
+  if (this->capacity == 0) {
+    return false;
+  }
+
+  /* A conjunct with the hash of another cached one is left out */
+  for (triton::usize i = 0; i < answer.conjuncts.size(); i++) {
+    auto f = this->forms.find(answer.conjuncts[i]);
+    if (f != this->forms.end() && !sameForm(f->second.form, forms[i])) {
+      return false;
+    }
+  }
+
+  /* The same query answered again takes the slot of the old answer, else
+   * a free slot or the one of the clock victim */
+  auto old = this->answers.find(hash);
+  if (old != this->answers.end()) {
+    answer.slot = old->second.slot;
+    this->releaseLocked(hash, old->second);
+  } else if (this->answers.size() >= this->capacity) {
+    answer.slot = this->evictLocked();
+  } else {
+    answer.slot = this->clock.size();
+    this->clock.push_back(hash);
+    this->referenced.emplace_back(false);
+  }
+  this->clock[answer.slot] = hash;
+
+  for (triton::usize i = 0; i < answer.conjuncts.size(); i++) {
+    auto &f = this->forms[answer.conjuncts[i]];
+    if (f.refs++ == 0) {
+      f.form = forms[i];
+    }
+  }
+  if (answer.status == triton::engines::solver::UNSAT &&
+      !answer.conjuncts.empty()) {
+    this->unsat[answer.conjuncts.front()].push_back(hash);
+  }
+  this->answers[hash] = std::move(answer);
+  return true;
+}
+
+void QueryCache::releaseLocked(triton::uint64 hash,
+                               const QueryAnswer &answer) {
+  for (auto c : answer.conjuncts) {
+    auto f = this->forms.find(c);
+    if (f != this->forms.end() && --f->second.refs == 0) {
+      this->forms.erase(f);
+    }
+  }
+  if (answer.status == triton::engines::solver::UNSAT &&
+      !answer.conjuncts.empty()) {
+    auto index = this->unsat.find(answer.conjuncts.front());
+    if (index != this->unsat.end()) {
+      auto &hashes = index->second;
+      hashes.erase(std::remove(hashes.begin(), hashes.end(), hash),
+                   hashes.end());
+      if (hashes.empty()) {
+        this->unsat.erase(index);
+      }
+    }
+  }
+}
+
+triton::usize QueryCache::evictLocked(void) {
+  /* Every answer used since the last turn gets a second chance */
+  while (this->referenced[this->hand].exchange(false)) {
+    this->hand = (this->hand + 1) % this->clock.size();
+  }
+  const auto slot = this->hand;
+  this->hand = (this->hand + 1) % this->clock.size();
+
+  auto victim = this->answers.find(this->clock[slot]);
+  this->releaseLocked(victim->first, victim->second);
+  this->answers.erase(victim);
+  this->nbEvicted++;
+  return slot;
+}
+
+bool QueryCache::load(const std::string &path, triton::uint64 fingerprint) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f.is_open()) {
+    return false;
+  }
+  std::vector<char> in((std::istreambuf_iterator<char>(f)),
+                       std::istreambuf_iterator<char>());
+
+  /* Answers of another version, binary or seed layout are not ours, the
+   * cache starts cold and save() replaces them */
+  triton::usize pos = 0;
+  triton::uint64 magic = 0, stamp = 0;
+  get(in, pos, magic);
+  if (magic != QUERY_CACHE_MAGIC) {
+    return false;
+  }
+  get(in, pos, stamp);
+  if (stamp != fingerprint) {
+    return false;
+  }
+
+  /* The forms first, the answers then share them */
+  std::unordered_map<triton::uint64, QueryForm> table;
+  triton::uint64 nforms = 0;
+  get(in, pos, nforms);
+  for (triton::uint64 i = 0; i < nforms; i++) {
+    triton::uint64 hash = 0, size = 0;
+    get(in, pos, hash);
+    get(in, pos, size);
+    if (pos + size > in.size()) {
+      throw triton::exceptions::Engines(
+          "QueryCache::load(): Truncated query cache.");
+    }
+    table[hash] = std::make_shared<const std::string>(in.data() + pos, size);
+    pos += size;
+  }
+
+  triton::uint64 count = 0;
+  get(in, pos, count);
+  std::unique_lock<std::shared_mutex> guard(this->lock);
+  for (triton::uint64 i = 0; i < count; i++) {
+    triton::uint64 hash = 0, limit = 0, nconjuncts = 0, nmodels = 0;
+    triton::uint32 status = 0;
+    QueryAnswer answer;
+    std::vector<QueryForm> forms;
+    bool complete = true;
+    get(in, pos, hash);
+    get(in, pos, status);
+    get(in, pos, limit);
+    get(in, pos, nconjuncts);
+    answer.status = static_cast<triton::engines::solver::status_e>(status);
+    answer.limit = limit;
+    answer.conjuncts.resize(nconjuncts);
+    for (auto &c : answer.conjuncts) {
+      get(in, pos, c);
+      auto f = table.find(c);
+      complete = complete && f != table.end();
+      forms.push_back(complete ? f->second : nullptr);
+    }
+    get(in, pos, nmodels);
+    answer.models.resize(nmodels);
+    for (auto &model : answer.models) {
+      triton::uint64 nvalues = 0;
+      get(in, pos, nvalues);
+      model.resize(nvalues);
+      for (auto &item : model) {
+        triton::uint64 id = 0;
+        get(in, pos, id);
+        get(in, pos, item.second);
+        item.first = id;
+      }
+    }
+    if (complete) {
+      this->insertLocked(hash, std::move(answer), forms);
+    }
+  }
+  return true;
+}
+
+void QueryCache::save(const std::string &path, triton::uint64 fingerprint) {
+  std::vector<char> out;
+  {
+    std::shared_lock<std::shared_mutex> guard(this->lock);
+    put(out, QUERY_CACHE_MAGIC);
+    put(out, fingerprint);
+    put<triton::uint64>(out, this->forms.size());
+    for (const auto &item : this->forms) {
+      const auto &form = *item.second.form;
+      put(out, item.first);
+      put<triton::uint64>(out, form.size());
+      out.insert(out.end(), form.begin(), form.end());
+    }
+
+    /* Oldest first from the hand, a reload evicts in the same order */
+    put<triton::uint64>(out, this->answers.size());
+    for (triton::usize i = 0; i < this->clock.size(); i++) {
+      const auto hash = this->clock[(this->hand + i) % this->clock.size()];
+      const auto &answer = this->answers.at(hash);
+      put(out, hash);
+      put<triton::uint32>(out, answer.status);
+      put<triton::uint64>(out, answer.limit);
+      put<triton::uint64>(out, answer.conjuncts.size());
+      for (auto c : answer.conjuncts) {
+        put(out, c);
+      }
+      put<triton::uint64>(out, answer.models.size());
+      for (const auto &model : answer.models) {
+        put<triton::uint64>(out, model.size());
+        for (const auto &value : model) {
+          put<triton::uint64>(out, value.first);
+          put(out, value.second);
+        }
+      }
+    }
+  }
+
+  const auto tmp = path + ".tmp";
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    f.write(out.data(), out.size());
+    if (!f) {
+      throw triton::exceptions::Engines("QueryCache::save(): Cannot write " +
+                                        tmp + ".");
+    }
+  }
+  std::filesystem::rename(tmp, path);
+}
+
+triton::usize QueryCache::size(void) {
+  std::shared_lock<std::shared_mutex> guard(this->lock);
+  return this->answers.size();
+}
+
+triton::uint64 QueryCache::hits(void) const { return this->nbHits; }
+
+triton::uint64 QueryCache::subsumed(void) const { return this->nbSubsumed; }
+
+triton::uint64 QueryCache::misses(void) const { return this->nbMisses; }
+
+triton::uint64 QueryCache::evicted(void) const { return this->nbEvicted; }
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
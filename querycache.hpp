@@ -0,0 +1,248 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_QUERYCACHE_H
+#define TRITON_QUERYCACHE_H
+
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <triton/ast.hpp>
+#include <triton/solverEnums.hpp>
+#include <triton/symbolicVariable.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include "solverpool.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Name of the persisted cache in the workspace.
+      constexpr const char* QUERY_CACHE_FILE = "queries.bin";
+
+      //! Magic of the persisted cache.
+      constexpr triton::uint64 QUERY_CACHE_MAGIC = 0x3330454843414351; /* "QCACHE03" */
+
+      //! Canonical serialization of a conjunct, operand order included, shared by the keys and the cache.
+      using QueryForm = std::shared_ptr<const std::string>;
+
+      //! A top level conjunct of a query.
+      struct QueryConjunct {
+        //! Hash of form.
+        triton::uint64 hash;
+
+        //! Canonical serialization of the conjunct.
+        QueryForm form;
+      };
+
+      //! A query, as the set of its top level conjuncts.
+      struct QueryKey {
+        //! False if the query cannot be cached, two of its conjuncts have the same hash.
+        bool valid = false;
+
+        //! Hash of the conjuncts.
+        triton::uint64 hash;
+
+        //! Hashes of the conjuncts, sorted, without duplicates.
+        std::vector<triton::uint64> conjuncts;
+
+        //! Forms of the conjuncts, in the same order.
+        std::vector<QueryForm> forms;
+      };
+
+      /*! \class QueryPrefix
+          \brief Conjuncts asserted along a path, extended one predicate at a time.
+
+          The conjuncts stay sorted, so the key of each branch merges the
+          prefix with the few conjuncts of the branch instead of sorting the
+          whole query again, and its forms are shared, not copied. */
+      class QueryPrefix {
+        private:
+          //! Sorted by hash, without duplicates.
+          std::vector<QueryConjunct> conjuncts;
+
+          //! False once two different conjuncts have the same hash.
+          bool valid = true;
+
+        public:
+          //! Assert the conjuncts of node.
+          void add(const triton::ast::SharedAbstractNode& node);
+
+          //! Key of the prefix and node.
+          QueryKey key(const triton::ast::SharedAbstractNode& node) const;
+      };
+
+      //! A cached answer.
+      struct QueryAnswer {
+        //! SAT or UNSAT, timeouts are not cached.
+        triton::engines::solver::status_e status;
+
+        //! Number of models asked when the query was solved.
+        triton::usize limit;
+
+        //! Models, as <variable id, value>.
+        std::vector<std::vector<std::pair<triton::usize, triton::uint64>>> models;
+
+        //! Conjuncts of the query.
+        std::vector<triton::uint64> conjuncts;
+
+        //! Slot of the answer in the eviction clock.
+        triton::usize slot;
+      };
+
+      //! A cached form and the number of answers using it.
+      struct QueryCachedForm {
+        //! The form.
+        QueryForm form;
+
+        //! Answers holding the conjunct.
+        triton::usize refs;
+      };
+
+      /*! \class QueryCache
+          \brief Solver answers by query, shared by the workers.
+
+          A query is keyed by the hashes of the canonical forms of its top
+          level conjuncts, which do not depend on the worker context nor on
+          the run. A hit only counts if the forms match too, and SAT models
+          are checked against the query before they are reused. Besides
+          exact hits, a query holding all the conjuncts of a cached UNSAT
+          query is UNSAT too. UNSAT queries are indexed by their smallest
+          conjunct for that test. A full cache evicts with the clock
+          algorithm: an answer used since the hand last passed it gets a
+          second chance, else it leaves with the forms only it used. */
+      class QueryCache {
+        private:
+          //! Protects the answers.
+          std::shared_mutex lock;
+
+          //! Answers by query hash.
+          std::unordered_map<triton::uint64, QueryAnswer> answers;
+
+          //! UNSAT query hashes by smallest conjunct.
+          std::unordered_map<triton::uint64, std::vector<triton::uint64>> unsat;
+
+          //! Forms of the cached conjuncts, by hash.
+          std::unordered_map<triton::uint64, QueryCachedForm> forms;
+
+          //! Answer hashes by clock slot.
+          std::vector<triton::uint64> clock;
+
+          //! Answers used since the hand passed, by clock slot.
+          std::deque<std::atomic<bool>> referenced;
+
+          //! Next slot the clock looks at.
+          triton::usize hand = 0;
+
+          //! Max number of answers, 0 disables the cache.
+          triton::usize capacity = 0;
+
+          //! Exact hits.
+          std::atomic<triton::uint64> nbHits{0};
+
+          //! UNSAT by subsumption.
+          std::atomic<triton::uint64> nbSubsumed{0};
+
+          //! Lookups sent to the solver.
+          std::atomic<triton::uint64> nbMisses{0};
+
+          //! Answers evicted to make room.
+          std::atomic<triton::uint64> nbEvicted{0};
+
+          //! Record an answer whose conjuncts have forms, the lock is held. False if a form collides.
+          bool insertLocked(triton::uint64 hash, QueryAnswer&& answer, const std::vector<QueryForm>& forms);
+
+          //! Drop an answer from the indexes and its forms, the lock is held.
+          void releaseLocked(triton::uint64 hash, const QueryAnswer& answer);
+
+          //! Free the slot of the clock victim, the lock is held.
+          triton::usize evictLocked(void);
+
+          //! True if the cached conjuncts of core are in key with the same forms, the lock is held.
+          bool matchLocked(const QueryKey& key, const std::vector<triton::uint64>& core) const;
+
+        public:
+          //! Returns the canonical form of node.
+          static std::string form(const triton::ast::SharedAbstractNode& node);
+
+          //! Add the conjuncts of node to out, constant true ones are dropped.
+          static void conjuncts(const triton::ast::SharedAbstractNode& node, std::vector<QueryConjunct>& out);
+
+          //! Key of a query made of node alone.
+          static QueryKey key(const triton::ast::SharedAbstractNode& node);
+
+          //! Forget everything, keep at most capacity answers from now on.
+          void reset(triton::usize capacity);
+
+          //! True if the cache is on.
+          bool enabled(void) const;
+
+          //! Answer a query asking for limit models. Models are rebuilt on vars, indexed by variable id, and only reused if check accepts them.
+          bool lookup(const QueryKey& key, triton::usize limit, const std::vector<triton::engines::symbolic::SharedSymbolicVariable>& vars,
+                      triton::engines::solver::status_e& status, Models& models, const std::function<bool(const Models&)>& check);
+
+          //! Record the answer of a query asking for limit models.
+          void insert(const QueryKey& key, triton::usize limit, triton::engines::solver::status_e status, const Models& models);
+
+          //! Load answers saved by save() with the same fingerprint. Returns false if there is no such file.
+          bool load(const std::string& path, triton::uint64 fingerprint);
+
+          //! Save the answers, stamped with a fingerprint of the binary and the seed layout.
+          void save(const std::string& path, triton::uint64 fingerprint);
+
+          //! Number of answers.
+          triton::usize size(void);
+
+          //! Exact hits.
+          triton::uint64 hits(void) const;
+
+          //! UNSAT by subsumption.
+          triton::uint64 subsumed(void) const;
+
+          //! Lookups sent to the solver.
+          triton::uint64 misses(void) const;
+
+          //! Answers evicted to make room.
+          triton::uint64 evicted(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_QUERYCACHE_H */
@@ -4,12 +4,12 @@
  **  Jonathan Salwan
  */
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstddef>
 #include <cstdlib>
 #include <iostream>
 #include <iterator>
-#include <regex>
 #include <triton/archEnums.hpp>
 #include <triton/architecture.hpp>
 #include <triton/context.hpp>
@@ -17,14 +17,18 @@
 #include <triton/memoryAccess.hpp>
 #include <vector>
 
+#include <cstdint>
 #include <cstdio>
+#include <stdexcept>
+#include <string_view>
 
+#include "format.hpp"
+#include "heap.hpp"
+#include "output.hpp"
 #include "routines.hpp"
 #include "ttexplore.hpp"
 #include "utils.hpp"
 
-extern bool DEBUG;
-
 /*
  * This file aims to provide an example about using routines when emulating a
  * target. For example, we provide a very simple printf routine that just prints
@@ -37,48 +41,174 @@ extern bool DEBUG;
 
 namespace triton {
 namespace routines {
+
+/*
+ * String and memory functions are summarized: the result is computed
+ * directly, and when the inputs are symbolic the return value gets one ITE
+ * chain over the bytes the concrete run looked at, instead of a path
+ * constraint per byte.
+ */
+namespace {
+thread_local GuestReader lhs, rhs;
+thread_local std::string formatted;
+// largest area a summary fills, copies or compares: a garbage length would
+// exhaust the host memory or hang the worker
+constexpr uint64 MAX_AREA = 0x1000000;
+
+void checkLength(const char *routine, uint64 len) {
+  if (len > MAX_AREA)
+    throw std::runtime_error(std::string(routine) + ": length too large");
+}
+
+ast::SharedAbstractNode memByte(triton::Context *ctx, uint64 addr) {
+  return ctx->getMemoryAst(arch::MemoryAccess(addr, size::byte));
+}
+
+// a - b on unsigned chars, as wide as the return register
+ast::SharedAbstractNode byteDiff(triton::Context *ctx,
+                                 const ast::SharedAbstractNode &a,
+                                 const ast::SharedAbstractNode &b) {
+  auto ast = ctx->getAstContext();
+  auto bits = ctx->getGprBitSize() - 8;
+  return ast->bvsub(ast->zx(bits, a), ast->zx(bits, b));
+}
+
+// first difference of a and b in count bytes, tail if there is none
+ast::SharedAbstractNode compareAst(triton::Context *ctx, uint64 a, uint64 b,
+                                   uint64 count, bool cstring,
+                                   ast::SharedAbstractNode tail) {
+  auto ast = ctx->getAstContext();
+  auto bits = ctx->getGprBitSize();
+  auto res = tail;
+  for (uint64 i = count; i-- > 0;) {
+    auto ai = memByte(ctx, a + i);
+    auto bi = memByte(ctx, b + i);
+    if (cstring)
+      res = ast->ite(ast->equal(ai, ast->bv(0, 8)),
+                     ast->bv(0, bits), res);
+    res = ast->ite(ast->distinct(ai, bi), byteDiff(ctx, ai, bi), res);
+  }
+  return res;
+}
+
+// the heap of the worker running the routine, none outside the exploration
+static engines::exploration::GuestHeap *guestHeap(void) {
+  auto w = engines::exploration::SymbolicExplorator::current;
+  return w ? &w->heap : nullptr;
+}
+
+// what the guest prints, captured per execution
+void guestOutput(triton::Context *ctx, const char *data, uint64 size) {
+  auto w = engines::exploration::SymbolicExplorator::current;
+  if (w)
+    w->output.write(data, size);
+  else
+    std::fwrite(data, 1, size, stdout);
+}
+
+// set the return register, symbolic if node is not null
+void setReturn(triton::Context *ctx, uint64 value,
+               const ast::SharedAbstractNode &node, const char *comment) {
+  auto &reg = ctx->getRegister(getGprId(ctx, GPR_RET));
+  ctx->setConcreteRegisterValue(reg, value);
+  if (node == nullptr) {
+    ctx->concretizeRegister(reg);
+    return;
+  }
+  auto expr = ctx->newSymbolicExpression(node, comment);
+  ctx->assignSymbolicExpressionToRegister(expr, reg);
+}
+
+// index of the first difference of a and b, in at most limit bytes
+uint64 mismatch(std::string_view a, std::string_view b, uint64 limit) {
+  uint64 n = 0;
+  while (n < limit && n < a.size() && n < b.size() && a[n] == b[n])
+    n++;
+  return n;
+}
+
+int byteAt(std::string_view s, uint64 i) {
+  return i < s.size() ? static_cast<unsigned char>(s[i]) : 0;
+}
+} // namespace
+
 triton::callbacks::cb_state_e __libc_start_main(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto main_loc = getArg(0);
+  auto main_loc = getArg(ctx, 0);
   std::vector<std::string> argv = {"./programm", "1", "2", "3", "4"};
   uint64 argc = argv.size();
 
   for (int i = 0; i < argc; i++) {
     uint8 *arg = reinterpret_cast<uint8 *>(argv[i].data());
-    auto ptr = allocate(arg, argv[i].size() + 1); // +1 for c-string
-    setStack(i + 3, ptr);
+    auto ptr = allocate(ctx, guestHeap(), arg, argv[i].size() + 1); // +1 for c-string
+    setStack(ctx, i + 3, ptr);
   }
 
   // set argc, argv & env
-  setArg(0, argc);
-  setArg(1, getStack(3));
-  setArg(2, 0);
+  setArg(ctx, 0, argc);
+  setArg(ctx, 1, getStack(ctx, 3));
+  setArg(ctx, 2, 0);
 
-  setGpr("ip", main_loc);
+  setGpr(ctx, GPR_IP, main_loc);
   return triton::callbacks::CONTINUE;
 }
 
-// TODO: add format string parser
 triton::callbacks::cb_state_e printf(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto format = getArg(0);
-  uint64 len = lenString(format);
-  // va_list ap;
-  // va_start(ap, static_cast<uint64>(gctx.getConcreteMemoryValue(format)));
-  // printf(readAsciiString(format).data(), ap);
-  // va_end(ap);
-  std::printf("%s\n", readUtf8String(format, len).data());
+  formatted.clear();
+  auto n = formatGuest(ctx, getArg(ctx, 0), 1, formatted);
+  guestOutput(ctx, formatted.data(), n);
+  setReturn(ctx, n, nullptr, "printf");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e fprintf(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  // every guest stream goes to stdout
+  formatted.clear();
+  auto n = formatGuest(ctx, getArg(ctx, 1), 2, formatted);
+  guestOutput(ctx, formatted.data(), n);
+  setReturn(ctx, n, nullptr, "fprintf");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e sprintf(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  formatted.clear();
+  auto n = formatGuest(ctx, getArg(ctx, 1), 2, formatted);
+  formatted += '\0';
+  writeBytes(ctx, getArg(ctx, 0), formatted.data(), n + 1);
+  setReturn(ctx, n, nullptr, "sprintf");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e snprintf(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto size = getArg(ctx, 1);
+  formatted.clear();
+  auto n = formatGuest(ctx, getArg(ctx, 2), 3, formatted);
+  if (size) {
+    // truncated, always terminated
+    auto len = std::min<uint64>(n, size - 1);
+    formatted.resize(len);
+    formatted += '\0';
+    writeBytes(ctx, getArg(ctx, 0), formatted.data(), len + 1);
+  }
+  setReturn(ctx, n, nullptr, "snprintf");
   return triton::callbacks::PLT_CONTINUE;
 }
 
 triton::callbacks::cb_state_e puts(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto format = getArg(0);
-  uint64 len = lenString(format);
-  std::printf("%s\n", readUtf8String(format, len).data());
+  auto str = readCString(ctx, getArg(ctx, 0));
+  guestOutput(ctx, str.data.data(), str.data.size());
+  guestOutput(ctx, "\n", 1);
   return triton::callbacks::PLT_CONTINUE;
 }
 
@@ -91,14 +221,15 @@ triton::callbacks::cb_state_e getlogin(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
   unsigned char user[] = "Hacker1337";
-  setGpr("ret", allocate(user, sizeof(user) + 1)); // +1 for c-string
+  // +1 for c-string
+  setGpr(ctx, GPR_RET, allocate(ctx, guestHeap(), user, sizeof(user) + 1));
   return triton::callbacks::PLT_CONTINUE;
 }
 
 triton::callbacks::cb_state_e usleep(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto timeout = getArg(0);
+  auto timeout = getArg(ctx, 0);
   debug_printf("Waiting %zd ms\n", timeout);
   return triton::callbacks::PLT_CONTINUE;
   callbacks::PLT_CONTINUE;
@@ -107,7 +238,7 @@ triton::callbacks::cb_state_e usleep(triton::Context *ctx) {
 triton::callbacks::cb_state_e sleep(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto timeout = getArg(0);
+  auto timeout = getArg(ctx, 0);
   debug_printf("Waiting %zd s\n", timeout);
   return triton::callbacks::PLT_CONTINUE;
 }
@@ -115,17 +246,17 @@ triton::callbacks::cb_state_e sleep(triton::Context *ctx) {
 triton::callbacks::cb_state_e putchar(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto c = static_cast<uint8>(getArg(0));
-  std::printf("%c", c);
+  auto c = static_cast<uint8>(getArg(ctx, 0));
+  guestOutput(ctx, reinterpret_cast<const char *>(&c), 1);
   debug_puts("\n");
-  setGpr("ret", c);
+  setGpr(ctx, GPR_RET, c);
   return triton::callbacks::PLT_CONTINUE;
 }
 
 triton::callbacks::cb_state_e exit(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto code = getArg(0);
+  auto code = getArg(ctx, 0);
   triton_printf("Exit: %zd\n", code);
   // std::exit(code);
   return triton::callbacks::BREAK;
@@ -134,8 +265,8 @@ triton::callbacks::cb_state_e exit(triton::Context *ctx) {
 triton::callbacks::cb_state_e fgets(triton::Context *ctx) {
   debug_printf("[i] Execute %s\n", __FUNCTION__);
 
-  auto buf = getArg(0);
-  auto len = getArg(1);
+  auto buf = getArg(ctx, 0);
+  auto len = getArg(ctx, 1);
   if (ctx->isMemorySymbolized(buf)) {
     return triton::callbacks::PLT_CONTINUE;
   }
@@ -144,8 +275,209 @@ triton::callbacks::cb_state_e fgets(triton::Context *ctx) {
   return triton::callbacks::PLT_CONTINUE;
 }
 
-triton::callbacks::cb_state_e stub(triton::Context *ctx) {
-  return triton::callbacks::CONTINUE;
+triton::callbacks::cb_state_e malloc(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto heap = guestHeap();
+  setGpr(ctx, GPR_RET, heap ? heap->malloc(getArg(ctx, 0)) : 0);
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e calloc(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto heap = guestHeap();
+  setGpr(ctx, GPR_RET,
+         heap ? heap->calloc(getArg(ctx, 0), getArg(ctx, 1)) : 0);
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e realloc(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto heap = guestHeap();
+  setGpr(ctx, GPR_RET,
+         heap ? heap->realloc(getArg(ctx, 0), getArg(ctx, 1)) : 0);
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e free(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto heap = guestHeap();
+  auto ptr = getArg(ctx, 0);
+  if (heap && !heap->free(ptr))
+    triton_printf("[!] free: invalid pointer %#zx\n", ptr);
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e strlen(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto s = getArg(ctx, 0);
+  auto str = lhs.cstring(ctx, s);
+  uint64 len = str.data.size();
+
+  ast::SharedAbstractNode node = nullptr;
+  if (str.symbolic) {
+    auto ast = ctx->getAstContext();
+    auto bits = ctx->getGprBitSize();
+    node = ast->bv(len, bits);
+    for (uint64 i = len; i-- > 0;)
+      node = ast->ite(ast->equal(memByte(ctx, s + i), ast->bv(0, 8)),
+                      ast->bv(i, bits), node);
+  }
+  setReturn(ctx, len, node, "strlen");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e strcmp(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto a = getArg(ctx, 0);
+  auto b = getArg(ctx, 1);
+  auto sa = lhs.cstring(ctx, a);
+  auto sb = rhs.cstring(ctx, b);
+
+  // the strings differ or both end at n
+  uint64 n = mismatch(sa.data, sb.data, UINT64_MAX);
+  int64_t diff = byteAt(sa.data, n) - byteAt(sb.data, n);
+
+  ast::SharedAbstractNode node = nullptr;
+  if (sa.symbolic || sb.symbolic)
+    node = compareAst(ctx, a, b, n, true,
+                      byteDiff(ctx, memByte(ctx, a + n), memByte(ctx, b + n)));
+  setReturn(ctx, static_cast<uint64>(diff), node, "strcmp");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e strncmp(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto a = getArg(ctx, 0);
+  auto b = getArg(ctx, 1);
+  auto limit = getArg(ctx, 2);
+  // n is often larger than the strings, only equal strings that long fail
+  auto bound = std::min(limit, MAX_AREA);
+  auto sa = lhs.cstring(ctx, a, bound);
+  auto sb = rhs.cstring(ctx, b, bound);
+
+  uint64 n = mismatch(sa.data, sb.data, bound);
+  if (n == bound && bound < limit)
+    checkLength("strncmp", limit);
+  int64_t diff = n < limit ? byteAt(sa.data, n) - byteAt(sb.data, n) : 0;
+
+  ast::SharedAbstractNode node = nullptr;
+  if (sa.symbolic || sb.symbolic) {
+    auto tail = n < limit ? byteDiff(ctx, memByte(ctx, a + n),
+                                     memByte(ctx, b + n))
+                          : ctx->getAstContext()->bv(0, ctx->getGprBitSize());
+    node = compareAst(ctx, a, b, n, true, tail);
+  }
+  setReturn(ctx, static_cast<uint64>(diff), node, "strncmp");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e memcmp(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto a = getArg(ctx, 0);
+  auto b = getArg(ctx, 1);
+  auto len = getArg(ctx, 2);
+  checkLength("memcmp", len);
+  auto sa = lhs.bytes(ctx, a, len);
+  auto sb = rhs.bytes(ctx, b, len);
+
+  uint64 n = mismatch(sa.data, sb.data, len);
+  int64_t diff = n < len ? byteAt(sa.data, n) - byteAt(sb.data, n) : 0;
+
+  ast::SharedAbstractNode node = nullptr;
+  if (sa.symbolic || sb.symbolic) {
+    auto tail = n < len ? byteDiff(ctx, memByte(ctx, a + n),
+                                   memByte(ctx, b + n))
+                        : ctx->getAstContext()->bv(0, ctx->getGprBitSize());
+    node = compareAst(ctx, a, b, n, false, tail);
+  }
+  setReturn(ctx, static_cast<uint64>(diff), node, "memcmp");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e memcpy(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto dst = getArg(ctx, 0);
+  auto len = getArg(ctx, 2);
+  checkLength("memcpy", len);
+  copyMemory(ctx, dst, getArg(ctx, 1), len);
+  setReturn(ctx, dst, nullptr, "memcpy");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e memset(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto dst = getArg(ctx, 0);
+  auto len = getArg(ctx, 2);
+  auto &creg = getArgReg(ctx, 1);
+  checkLength("memset", len);
+
+  // one page at a time, as GuestReader reads
+  constexpr uint64 page = 0x1000;
+  std::vector<uint8> fill(std::min(len, page),
+                          static_cast<uint8>(getArg(ctx, 1)));
+  for (uint64 done = 0; done < len;) {
+    uint64 addr = dst + done;
+    uint64 chunk = std::min(page - (addr & (page - 1)), len - done);
+    ctx->setConcreteMemoryAreaValue(addr, fill.data(), chunk);
+    done += chunk;
+  }
+
+  // the bytes follow the fill value
+  bool symbolic = ctx->isRegisterSymbolized(creg);
+  auto value = symbolic ? ctx->getAstContext()->extract(
+                              7, 0, ctx->getRegisterAst(creg))
+                        : nullptr;
+  for (uint64 i = 0; i < len; i++) {
+    if (symbolic)
+      ctx->assignSymbolicExpressionToMemory(
+          ctx->newSymbolicExpression(value, "memset"),
+          arch::MemoryAccess(dst + i, size::byte));
+    else if (ctx->isMemorySymbolized(dst + i))
+      ctx->concretizeMemory(dst + i);
+  }
+  setReturn(ctx, dst, nullptr, "memset");
+  return triton::callbacks::PLT_CONTINUE;
+}
+
+triton::callbacks::cb_state_e strchr(triton::Context *ctx) {
+  debug_printf("[i] Execute %s\n", __FUNCTION__);
+
+  auto s = getArg(ctx, 0);
+  auto &creg = getArgReg(ctx, 1);
+  auto c = static_cast<char>(getArg(ctx, 1));
+  auto str = lhs.cstring(ctx, s);
+
+  // the terminator is part of the string
+  auto pos = c ? str.data.find(c) : str.data.size();
+  uint64 ret = pos != std::string_view::npos ? s + pos : 0;
+  uint64 k = pos != std::string_view::npos ? pos : str.data.size();
+
+  ast::SharedAbstractNode node = nullptr;
+  if (str.symbolic || ctx->isRegisterSymbolized(creg)) {
+    auto ast = ctx->getAstContext();
+    auto bits = ctx->getGprBitSize();
+    auto cnode = ast->extract(7, 0, ctx->getRegisterAst(creg));
+    node = ast->ite(ast->equal(memByte(ctx, s + k), cnode),
+                    ast->bv(s + k, bits), ast->bv(0, bits));
+    for (uint64 i = k; i-- > 0;) {
+      auto si = memByte(ctx, s + i);
+      node = ast->ite(ast->equal(si, cnode), ast->bv(s + i, bits),
+                      ast->ite(ast->equal(si, ast->bv(0, 8)),
+                               ast->bv(0, bits), node));
+    }
+  }
+  setReturn(ctx, ret, node, "strchr");
+  return triton::callbacks::PLT_CONTINUE;
 }
 }; // namespace routines
 }; // namespace triton
@@ -32,6 +32,12 @@ namespace triton {
     triton::callbacks::cb_state_e __libc_start_main(triton::Context* ctx);
     //! printf routine
     triton::callbacks::cb_state_e printf(triton::Context* ctx);
+    //! fprintf routine
+    triton::callbacks::cb_state_e fprintf(triton::Context* ctx);
+    //! sprintf routine
+    triton::callbacks::cb_state_e sprintf(triton::Context* ctx);
+    //! snprintf routine
+    triton::callbacks::cb_state_e snprintf(triton::Context* ctx);
     //! puts routine
     triton::callbacks::cb_state_e puts(triton::Context* ctx);
     //! fflush routine
@@ -48,10 +54,28 @@ namespace triton {
     triton::callbacks::cb_state_e exit(triton::Context* ctx);
     //! strlen routine
     triton::callbacks::cb_state_e strlen(triton::Context* ctx);
+    //! strcmp routine
+    triton::callbacks::cb_state_e strcmp(triton::Context* ctx);
+    //! strncmp routine
+    triton::callbacks::cb_state_e strncmp(triton::Context* ctx);
+    //! memcmp routine
+    triton::callbacks::cb_state_e memcmp(triton::Context* ctx);
+    //! memcpy routine
+    triton::callbacks::cb_state_e memcpy(triton::Context* ctx);
+    //! memset routine
+    triton::callbacks::cb_state_e memset(triton::Context* ctx);
+    //! strchr routine
+    triton::callbacks::cb_state_e strchr(triton::Context* ctx);
     //! fgets routine
     triton::callbacks::cb_state_e fgets(triton::Context* ctx);
-    //! stub routine
-    triton::callbacks::cb_state_e stub(triton::Context* ctx);
+    //! malloc routine
+    triton::callbacks::cb_state_e malloc(triton::Context* ctx);
+    //! calloc routine
+    triton::callbacks::cb_state_e calloc(triton::Context* ctx);
+    //! realloc routine
+    triton::callbacks::cb_state_e realloc(triton::Context* ctx);
+    //! free routine
+    triton::callbacks::cb_state_e free(triton::Context* ctx);
 
   /*! @} End of routines namespace */
   };
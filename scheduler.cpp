@@ -0,0 +1,166 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <algorithm>
+
+#include <triton/exceptions.hpp>
+
+#include "scheduler.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+std::unique_ptr<Scheduler> Scheduler::create(schedule_e policy,
+                                             triton::usize restart,
+                                             triton::uint64 seed) {
+  switch (policy) {
+  case SCHEDULE_DFS:
+    return std::make_unique<DfsScheduler>();
+  case SCHEDULE_BFS:
+    return std::make_unique<BfsScheduler>();
+  case SCHEDULE_NOVELTY:
+    return std::make_unique<PriorityScheduler>(
+        [](const SeedEntry &a, const SeedEntry &b) {
+          if (a.novel != b.novel)
+            return b.novel;
+          return a.order < b.order;
+        });
+  case SCHEDULE_FEWEST_HITS:
+    return std::make_unique<PriorityScheduler>(
+        [](const SeedEntry &a, const SeedEntry &b) {
+          if (a.hits != b.hits)
+            return a.hits > b.hits;
+          return a.order < b.order;
+        });
+  case SCHEDULE_RANDOM_RESTART:
+    return std::make_unique<RandomRestartScheduler>(restart, seed);
+  default:
+    throw triton::exceptions::Engines(
+        "Scheduler::create(): Invalid policy");
+  }
+}
+
+const char *Scheduler::name(schedule_e policy) {
+  switch (policy) {
+  case SCHEDULE_DFS:
+    return "dfs";
+  case SCHEDULE_BFS:
+    return "bfs";
+  case SCHEDULE_NOVELTY:
+    return "novelty";
+  case SCHEDULE_FEWEST_HITS:
+    return "fewest-hits";
+  case SCHEDULE_RANDOM_RESTART:
+    return "random-restart";
+  default:
+    return "unknown";
+  }
+}
+
+bool Scheduler::parse(const std::string &name, schedule_e &policy) {
+  for (auto p : {SCHEDULE_DFS, SCHEDULE_BFS, SCHEDULE_NOVELTY,
+                 SCHEDULE_FEWEST_HITS, SCHEDULE_RANDOM_RESTART}) {
+    if (name == Scheduler::name(p)) {
+      policy = p;
+      return true;
+    }
+  }
+  return false;
+}
+
+void DfsScheduler::push(SeedEntry &&entry) {
+  this->entries.push_front(std::move(entry));
+}
+
+bool DfsScheduler::pop(SeedEntry &entry) {
+  if (this->entries.empty())
+    return false;
+  entry = std::move(this->entries.front());
+  this->entries.pop_front();
+  return true;
+}
+
+bool DfsScheduler::steal(SeedEntry &entry) {
+  if (this->entries.empty())
+    return false;
+  entry = std::move(this->entries.back());
+  this->entries.pop_back();
+  return true;
+}
+
+triton::usize DfsScheduler::size(void) const {
+  return this->entries.size();
+}
+
+void DfsScheduler::copy(std::vector<SeedEntry> &out) const {
+  out.insert(out.end(), this->entries.begin(), this->entries.end());
+}
+
+void BfsScheduler::push(SeedEntry &&entry) {
+  this->entries.push_back(std::move(entry));
+}
+
+bool BfsScheduler::steal(SeedEntry &entry) {
+  return this->pop(entry);
+}
+
+PriorityScheduler::PriorityScheduler(compare_t cmp) {
+  this->cmp = cmp;
+}
+
+void PriorityScheduler::push(SeedEntry &&entry) {
+  this->heap.push_back(std::move(entry));
+  std::push_heap(this->heap.begin(), this->heap.end(), this->cmp);
+}
+
+bool PriorityScheduler::pop(SeedEntry &entry) {
+  if (this->heap.empty())
+    return false;
+  std::pop_heap(this->heap.begin(), this->heap.end(), this->cmp);
+  entry = std::move(this->heap.back());
+  this->heap.pop_back();
+  return true;
+}
+
+bool PriorityScheduler::steal(SeedEntry &entry) {
+  return this->pop(entry);
+}
+
+triton::usize PriorityScheduler::size(void) const {
+  return this->heap.size();
+}
+
+void PriorityScheduler::copy(std::vector<SeedEntry> &out) const {
+  out.insert(out.end(), this->heap.begin(), this->heap.end());
+}
+
+RandomRestartScheduler::RandomRestartScheduler(triton::usize restart,
+                                               triton::uint64 seed)
+    : rng(seed) {
+  this->restart = restart;
+  this->picks = 0;
+}
+
+bool RandomRestartScheduler::pop(SeedEntry &entry) {
+  if (this->entries.empty())
+    return false;
+
+  this->picks++;
+  if (this->restart == 0 || this->picks % this->restart != 0)
+    return DfsScheduler::pop(entry);
+
+  /* Restart from anywhere in the tree */
+  std::uniform_int_distribution<triton::usize> dist(0,
+                                                    this->entries.size() - 1);
+  auto it = this->entries.begin() + dist(this->rng);
+  entry = std::move(*it);
+  this->entries.erase(it);
+  return true;
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
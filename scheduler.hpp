@@ -0,0 +1,160 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_SCHEDULER_H
+#define TRITON_SCHEDULER_H
+
+
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Shortcut for a seed: the bytes of the symbolic variables, see SeedLayout.
+      using Seed = std::vector<triton::uint8>;
+
+      //! Seed scheduling policies.
+      enum schedule_e {
+        SCHEDULE_DFS,            //!< Newest seed first.
+        SCHEDULE_BFS,            //!< Oldest seed first.
+        SCHEDULE_NOVELTY,        //!< Seeds produced by runs that hit new edges first.
+        SCHEDULE_FEWEST_HITS,    //!< Seeds aiming at the least hit edge first.
+        SCHEDULE_RANDOM_RESTART, //!< DFS, with a random seed every restart_interval picks.
+      };
+
+      //! A seed and what the scheduler knows about it.
+      struct SeedEntry {
+        //! The seed.
+        Seed seed;
+
+        //! Hits of the edge the seed aims at, when it was produced.
+        triton::uint32 hits;
+
+        //! True if the run which produced the seed hit new edges.
+        bool novel;
+
+        //! Push order, set by the worklist.
+        triton::usize order;
+      };
+
+      /*! \class Scheduler
+          \brief The seeds of one worklist lane, in the order of a policy. */
+      class Scheduler {
+        public:
+          //! Destructor.
+          virtual ~Scheduler() = default;
+
+          //! Add a seed.
+          virtual void push(SeedEntry&& entry) = 0;
+
+          //! Take the next seed of the owner of the lane.
+          virtual bool pop(SeedEntry& entry) = 0;
+
+          //! Take a seed for another worker.
+          virtual bool steal(SeedEntry& entry) = 0;
+
+          //! Number of seeds.
+          virtual triton::usize size(void) const = 0;
+
+          //! Append a copy of every seed to out, in no particular order.
+          virtual void copy(std::vector<SeedEntry>& out) const = 0;
+
+          //! Create a scheduler.
+          static std::unique_ptr<Scheduler> create(schedule_e policy, triton::usize restart, triton::uint64 seed);
+
+          //! Name of a policy.
+          static const char* name(schedule_e policy);
+
+          //! Policy of a name, false if unknown.
+          static bool parse(const std::string& name, schedule_e& policy);
+      };
+
+      //! Depth first: the owner takes the newest seed, thieves the oldest.
+      class DfsScheduler : public Scheduler {
+        protected:
+          std::deque<SeedEntry> entries;
+
+        public:
+          void push(SeedEntry&& entry) override;
+          bool pop(SeedEntry& entry) override;
+          bool steal(SeedEntry& entry) override;
+          triton::usize size(void) const override;
+          void copy(std::vector<SeedEntry>& out) const override;
+      };
+
+      //! Breadth first: everyone takes the oldest seed.
+      class BfsScheduler : public DfsScheduler {
+        public:
+          void push(SeedEntry&& entry) override;
+          bool steal(SeedEntry& entry) override;
+      };
+
+      //! Priority order, best seed first for owner and thieves.
+      class PriorityScheduler : public Scheduler {
+        public:
+          //! Returns true if a must be taken after b.
+          using compare_t = bool (*)(const SeedEntry& a, const SeedEntry& b);
+
+        private:
+          std::vector<SeedEntry> heap;
+          compare_t cmp;
+
+        public:
+          PriorityScheduler(compare_t cmp);
+          void push(SeedEntry&& entry) override;
+          bool pop(SeedEntry& entry) override;
+          bool steal(SeedEntry& entry) override;
+          triton::usize size(void) const override;
+          void copy(std::vector<SeedEntry>& out) const override;
+      };
+
+      //! Depth first with a uniformly random pick every restart pops.
+      class RandomRestartScheduler : public DfsScheduler {
+        private:
+          triton::usize restart;
+          triton::usize picks;
+          std::mt19937_64 rng;
+
+        public:
+          RandomRestartScheduler(triton::usize restart, triton::uint64 seed);
+          bool pop(SeedEntry& entry) override;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_SCHEDULER_H */
@@ -0,0 +1,107 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <triton/coreUtils.hpp>
+#include <triton/cpuSize.hpp>
+
+#include "seedlayout.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+void SeedLayout::init(triton::Context *ctx) {
+  const auto nbvars = ctx->getSymbolicVariables().size();
+
+  this->offsets.clear();
+  this->sizes.clear();
+  this->defaults.clear();
+  for (triton::usize i = 0; i < nbvars; i++) {
+    const auto &var = ctx->getSymbolicVariable(i);
+    const triton::uint32 size =
+        (var->getSize() + triton::bitsize::byte - 1) / triton::bitsize::byte;
+    const auto value = ctx->getConcreteVariableValue(var);
+
+    this->offsets.push_back(this->defaults.size());
+    this->sizes.push_back(size);
+    for (triton::uint32 j = 0; j < size; j++) {
+      this->defaults.push_back(
+          triton::utils::cast<triton::uint8>(value >> (j * 8)));
+    }
+  }
+}
+
+Seed SeedLayout::fromModel(
+    const std::unordered_map<triton::usize,
+                             triton::engines::solver::SolverModel> &model)
+    const {
+  return this->fromModel(model, this->defaults);
+}
+
+Seed SeedLayout::fromModel(
+    const std::unordered_map<triton::usize,
+                             triton::engines::solver::SolverModel> &model,
+    const Seed &base) const {
+  Seed seed(base);
+  seed.resize(this->defaults.size());
+  for (const auto &item : model) {
+    if (item.first >= this->offsets.size()) {
+      continue;
+    }
+    const auto value = item.second.getValue();
+    const auto offset = this->offsets[item.first];
+    for (triton::uint32 j = 0; j < this->sizes[item.first]; j++) {
+      seed[offset + j] = triton::utils::cast<triton::uint8>(value >> (j * 8));
+    }
+  }
+  return seed;
+}
+
+void SeedLayout::inject(
+    triton::Context *ctx,
+    const std::vector<triton::engines::symbolic::SharedSymbolicVariable> &vars,
+    const Seed &seed) const {
+  for (triton::usize i = 0; i < vars.size(); i++) {
+    const auto offset = this->offsets[i];
+    const auto size = this->sizes[i];
+
+    /* Byte variables are the common case */
+    if (size == 1) {
+      ctx->setConcreteVariableValue(vars[i], seed[offset]);
+      continue;
+    }
+
+    triton::uint512 value = 0;
+    for (triton::uint32 j = size; j > 0; j--) {
+      value = (value << 8) | seed[offset + j - 1];
+    }
+    ctx->setConcreteVariableValue(vars[i], value);
+  }
+}
+
+triton::usize SeedLayout::variables(void) const {
+  return this->offsets.size();
+}
+
+triton::usize SeedLayout::size(void) const {
+  return this->defaults.size();
+}
+
+triton::uint64 SeedLayout::fingerprint(void) const {
+  /* FNV-1a over every variable and the initial seed */
+  triton::uint64 h = 0xcbf29ce484222325;
+  for (triton::usize i = 0; i < this->offsets.size(); i++) {
+    h = (h ^ this->offsets[i]) * 0x100000001b3;
+    h = (h ^ this->sizes[i]) * 0x100000001b3;
+  }
+  for (auto byte : this->defaults) {
+    h = (h ^ byte) * 0x100000001b3;
+  }
+  return h;
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
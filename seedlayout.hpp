@@ -0,0 +1,92 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_SEEDLAYOUT_H
+#define TRITON_SEEDLAYOUT_H
+
+
+#include <unordered_map>
+#include <vector>
+
+#include <triton/context.hpp>
+#include <triton/solverModel.hpp>
+#include <triton/tritonTypes.hpp>
+
+#include "scheduler.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      /*! \class SeedLayout
+          \brief Where each symbolic variable lives in a flat seed.
+
+          Variables are laid out by id, little endian, each on its own byte
+          size. The layout is built once and shared by every seed, a seed is
+          only its bytes. Variables a model does not constrain take their
+          initial concrete value. */
+      class SeedLayout {
+        private:
+          //! Offset of each variable.
+          std::vector<triton::usize> offsets;
+
+          //! Size of each variable in bytes.
+          std::vector<triton::uint32> sizes;
+
+          //! Initial value of the seed.
+          Seed defaults;
+
+        public:
+          //! Build the layout from the variables of ctx and their current values.
+          void init(triton::Context* ctx);
+
+          //! Convert a solver model into a seed.
+          Seed fromModel(const std::unordered_map<triton::usize, triton::engines::solver::SolverModel>& model) const;
+
+          //! Convert a solver model into a seed, the variables it does not constrain keep their value in base.
+          Seed fromModel(const std::unordered_map<triton::usize, triton::engines::solver::SolverModel>& model, const Seed& base) const;
+
+          //! Set the variables of ctx from a seed. vars are the variables of ctx, by id.
+          void inject(triton::Context* ctx, const std::vector<triton::engines::symbolic::SharedSymbolicVariable>& vars, const Seed& seed) const;
+
+          //! Number of variables.
+          triton::usize variables(void) const;
+
+          //! Size of a seed in bytes.
+          triton::usize size(void) const;
+
+          //! Hash of the offsets, sizes and initial values.
+          triton::uint64 fingerprint(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_SEEDLAYOUT_H */
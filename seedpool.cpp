@@ -0,0 +1,48 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include "seedpool.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+void SeedPool::reset(triton::usize capacity) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->recent.clear();
+  this->diverse.clear();
+  this->capacity = capacity;
+}
+
+void SeedPool::add(const Seed &seed, bool novel) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  if (this->capacity == 0) {
+    return;
+  }
+
+  /* With an odd capacity, the extra seed goes to the recent ones */
+  this->recent.push_back(seed);
+  if (this->recent.size() > this->capacity - this->capacity / 2) {
+    this->recent.pop_front();
+  }
+  if (novel && this->capacity / 2) {
+    this->diverse.push_back(seed);
+    if (this->diverse.size() > this->capacity / 2) {
+      this->diverse.pop_front();
+    }
+  }
+}
+
+void SeedPool::sample(std::vector<Seed> &out) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  out.assign(this->recent.rbegin(), this->recent.rend());
+  out.insert(out.end(), this->diverse.rbegin(), this->diverse.rend());
+}
+
+bool SeedPool::enabled(void) const { return this->capacity != 0; }
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
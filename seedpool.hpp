@@ -0,0 +1,84 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_SEEDPOOL_H
+#define TRITON_SEEDPOOL_H
+
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+#include "scheduler.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      /*! \class SeedPool
+          \brief A bounded set of executed seeds, tried before the solver.
+
+          Half of the pool holds the last executed seeds, the other half the
+          last ones that hit new coverage, which lean toward other parts of
+          the target. */
+      class SeedPool {
+        private:
+          //! Protects the seeds.
+          std::mutex lock;
+
+          //! Last executed seeds.
+          std::deque<Seed> recent;
+
+          //! Last executed seeds with new coverage.
+          std::deque<Seed> diverse;
+
+          //! Max number of seeds, 0 disables the pool.
+          triton::usize capacity = 0;
+
+        public:
+          //! Forget the seeds, keep at most capacity of them from now on.
+          void reset(triton::usize capacity);
+
+          //! Add an executed seed, novel if it hit new coverage.
+          void add(const Seed& seed, bool novel);
+
+          //! Copy the seeds, recent ones first.
+          void sample(std::vector<Seed>& out);
+
+          //! True if the pool is on.
+          bool enabled(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_SEEDPOOL_H */
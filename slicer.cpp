@@ -0,0 +1,83 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <algorithm>
+
+#include <triton/symbolicVariable.hpp>
+
+#include "slicer.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+triton::usize ConstraintSlicer::find(triton::usize var) {
+  if (var >= this->parent.size()) {
+    const auto size = this->parent.size();
+    this->parent.resize(var + 1);
+    for (triton::usize i = size; i <= var; i++) {
+      this->parent[i] = i;
+    }
+  }
+  /* Path halving */
+  while (this->parent[var] != var) {
+    this->parent[var] = this->parent[this->parent[var]];
+    var = this->parent[var];
+  }
+  return var;
+}
+
+void ConstraintSlicer::variables(const triton::ast::SharedAbstractNode &node,
+                                 std::vector<triton::usize> &out) {
+  for (const auto &n : triton::ast::search(node, triton::ast::VARIABLE_NODE)) {
+    const auto var = static_cast<triton::ast::VariableNode *>(n.get());
+    out.push_back(var->getSymbolicVariable()->getId());
+  }
+}
+
+void ConstraintSlicer::add(const triton::ast::SharedAbstractNode &predicate) {
+  std::vector<triton::usize> vars;
+  ConstraintSlicer::variables(predicate, vars);
+  if (vars.empty()) {
+    return;
+  }
+  const auto root = this->find(vars.front());
+  for (auto var : vars) {
+    this->parent[this->find(var)] = root;
+  }
+  this->constraints.emplace_back(predicate, vars.front());
+}
+
+triton::ast::SharedAbstractNode
+ConstraintSlicer::slice(const triton::ast::SharedAstContext &ast,
+                        const triton::ast::SharedAbstractNode &node,
+                        triton::usize &kept) {
+  std::vector<triton::usize> roots;
+  ConstraintSlicer::variables(node, roots);
+  for (auto &var : roots) {
+    var = this->find(var);
+  }
+  std::sort(roots.begin(), roots.end());
+  roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+
+  /* The predicates of the groups of node, in path order */
+  auto query = node;
+  kept = 0;
+  for (const auto &c : this->constraints) {
+    if (std::binary_search(roots.begin(), roots.end(), this->find(c.second))) {
+      query = ast->land(query, c.first);
+      kept++;
+    }
+  }
+  return query;
+}
+
+triton::usize ConstraintSlicer::size(void) const {
+  return this->constraints.size();
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
@@ -0,0 +1,81 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_SLICER_H
+#define TRITON_SLICER_H
+
+
+#include <vector>
+
+#include <triton/ast.hpp>
+#include <triton/astContext.hpp>
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      /*! \class ConstraintSlicer
+          \brief Constraint independence along a trace.
+
+          The taken predicates are added in path order. Variables that appear
+          in a same predicate are merged in a union-find, so that a branch
+          only needs the predicates of the groups of its own variables. The
+          other predicates constrain other variables, which keep their value
+          of the current seed. */
+      class ConstraintSlicer {
+        private:
+          //! Union-find parent of each variable id.
+          std::vector<triton::usize> parent;
+
+          //! Taken predicates with one of their variables.
+          std::vector<std::pair<triton::ast::SharedAbstractNode, triton::usize>> constraints;
+
+          //! Root of the group of a variable.
+          triton::usize find(triton::usize var);
+
+          //! Variable ids of an expression.
+          static void variables(const triton::ast::SharedAbstractNode& node, std::vector<triton::usize>& out);
+
+        public:
+          //! Add a taken predicate. Predicates without variables are dropped.
+          void add(const triton::ast::SharedAbstractNode& predicate);
+
+          //! Conjunction of node and the predicates it depends on, kept is their number.
+          triton::ast::SharedAbstractNode slice(const triton::ast::SharedAstContext& ast, const triton::ast::SharedAbstractNode& node, triton::usize& kept);
+
+          //! Number of predicates.
+          triton::usize size(void) const;
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_SLICER_H */
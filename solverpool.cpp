@@ -0,0 +1,181 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <chrono>
+#include <exception>
+#include <string>
+
+#include "solverpool.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+SolverPool::SolverPool() {
+  this->stopping = false;
+  this->inflight = 0;
+}
+
+SolverPool::~SolverPool() {
+  this->stop();
+}
+
+void SolverPool::start(triton::usize nbthreads) {
+  this->stopping = false;
+#ifndef TRITON_Z3_INTERFACE
+  /* The threads would have to share the Triton context of the workers */
+  nbthreads = 0;
+#endif
+  for (triton::usize i = 0; i < nbthreads; i++) {
+    this->threads.emplace_back(&SolverPool::work, this);
+  }
+}
+
+void SolverPool::stop(void) {
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->stopping = true;
+  }
+  this->cond.notify_all();
+  for (auto &t : this->threads) {
+    t.join();
+  }
+  this->threads.clear();
+}
+
+void SolverPool::submit(SolverJob job) {
+#ifdef TRITON_Z3_INTERFACE
+  /* Detach the query from the emulation: from now on it only lives in its
+   * own Z3 context */
+  job.converter = std::make_unique<triton::ast::TritonToZ3>();
+  job.expr = std::make_unique<z3::expr>(job.converter->convert(job.node));
+#endif
+  job.node = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->jobs.push_back(std::move(job));
+  }
+  this->cond.notify_one();
+}
+
+void SolverPool::work(void) {
+  while (true) {
+    SolverJob job;
+    {
+      std::unique_lock<std::mutex> guard(this->lock);
+      this->cond.wait(guard, [this] {
+        return this->stopping || this->jobs.size();
+      });
+      if (this->jobs.empty()) {
+        return;
+      }
+      job = std::move(this->jobs.front());
+      this->jobs.pop_front();
+      this->inflight++;
+    }
+
+    triton::engines::solver::status_e status = triton::engines::solver::UNKNOWN;
+    Models models;
+    auto start = std::chrono::steady_clock::now();
+#ifdef TRITON_Z3_INTERFACE
+    try {
+      z3::solver solver(job.expr->ctx());
+      if (job.timeout) {
+        z3::params p(job.expr->ctx());
+        p.set("timeout", static_cast<unsigned>(job.timeout * 1000));
+        solver.set(p);
+      }
+      solver.add(*job.expr);
+      status = SolverPool::enumerate(solver, *job.converter, job.limit, models);
+    } catch (const z3::exception &) {
+      status = models.empty() ? triton::engines::solver::UNKNOWN
+                              : triton::engines::solver::SAT;
+    }
+#endif
+    const triton::uint64 time =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+
+    /* Release the Z3 context before publishing the result */
+#ifdef TRITON_Z3_INTERFACE
+    job.expr.reset();
+    job.converter.reset();
+#endif
+    job.callback(status, models, time);
+    this->inflight--;
+  }
+}
+
+triton::usize SolverPool::queueDepth(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->jobs.size();
+}
+
+triton::usize SolverPool::inFlight(void) const {
+  return this->inflight;
+}
+
+bool SolverPool::isRunning(void) const {
+  return this->threads.size() != 0;
+}
+
+#ifdef TRITON_Z3_INTERFACE
+triton::engines::solver::status_e
+SolverPool::enumerate(z3::solver &solver, triton::ast::TritonToZ3 &converter,
+                      triton::usize limit, Models &models) {
+  auto status = triton::engines::solver::UNSAT;
+
+  while (models.size() < limit) {
+    auto res = solver.check();
+    if (res == z3::unknown) {
+      if (status != triton::engines::solver::SAT) {
+        auto reason = solver.reason_unknown();
+        status = (reason.find("timeout") != std::string::npos ||
+                  reason.find("canceled") != std::string::npos)
+                     ? triton::engines::solver::TIMEOUT
+                     : triton::engines::solver::UNKNOWN;
+      }
+      break;
+    }
+    if (res == z3::unsat) {
+      break;
+    }
+
+    /* Extract the model and block it for the next one. Symbolic variables
+     * are at most 64 bits wide in this explorer. */
+    status = triton::engines::solver::SAT;
+    z3::model m = solver.get_model();
+    z3::expr_vector blocking(solver.ctx());
+    std::unordered_map<triton::usize, triton::engines::solver::SolverModel>
+        model;
+    for (unsigned i = 0; i < m.size(); i++) {
+      z3::func_decl decl = m[i];
+      if (decl.arity() != 0) {
+        continue;
+      }
+      auto var = converter.variables.find(decl.name().str());
+      if (var == converter.variables.end()) {
+        continue;
+      }
+      z3::expr value = m.get_const_interp(decl);
+      model[var->second->getId()] = triton::engines::solver::SolverModel(
+          var->second, value.get_numeral_uint64());
+      blocking.push_back(decl() != value);
+    }
+    models.push_back(model);
+    if (blocking.empty()) {
+      break;
+    }
+    solver.add(z3::mk_or(blocking));
+  }
+
+  return status;
+}
+#endif
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
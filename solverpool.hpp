@@ -0,0 +1,155 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_SOLVERPOOL_H
+#define TRITON_SOLVERPOOL_H
+
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <triton/ast.hpp>
+#include <triton/context.hpp>
+#include <triton/solverEnums.hpp>
+#include <triton/solverModel.hpp>
+#include <triton/tritonTypes.hpp>
+
+#if __has_include(<triton/tritonToZ3.hpp>) && __has_include(<z3++.h>)
+#define TRITON_Z3_INTERFACE
+#include <triton/tritonToZ3.hpp>
+#include <z3++.h>
+#endif
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Shortcut for the models returned by the solver.
+      using Models = std::vector<std::unordered_map<triton::usize, triton::engines::solver::SolverModel>>;
+
+      //! Solver job completion signature, time is the solving time in microseconds.
+      using solverCallback = std::function<void(triton::engines::solver::status_e status, const Models& models, triton::uint64 time)>;
+
+      //! A query sent to the solver pool.
+      struct SolverJob {
+        //! The query, converted and released by SolverPool::submit().
+        triton::ast::SharedAbstractNode node;
+
+#ifdef TRITON_Z3_INTERFACE
+        //! Converter of the query, owns its Z3 context and maps the variable names back.
+        std::unique_ptr<triton::ast::TritonToZ3> converter;
+
+        //! The query in the converter context, destroyed before it.
+        std::unique_ptr<z3::expr> expr;
+#endif
+
+        //! Max number of models.
+        triton::usize limit;
+
+        //! Timeout in seconds.
+        triton::usize timeout;
+
+        //! Called from the solver thread once the query is answered.
+        solverCallback callback;
+      };
+
+      /*! \class SolverPool
+          \brief A pool of threads answering solver queries.
+
+          Emulation keeps running while the queries are solved. Each job is
+          converted to Z3 in the submitting thread, in a Z3 context of its
+          own, so the solver threads never touch a Triton context or AST
+          that the emulation is still using. Without the Z3 interface of
+          Triton the pool has no thread and queries are solved in place. */
+      class SolverPool {
+        private:
+          //! Solver threads.
+          std::vector<std::thread> threads;
+
+          //! Pending jobs.
+          std::deque<SolverJob> jobs;
+
+          //! Protects the jobs.
+          std::mutex lock;
+
+          //! Signaled when a job is submitted or when the pool stops.
+          std::condition_variable cond;
+
+          //! True when the threads must exit.
+          bool stopping;
+
+          //! Number of jobs being solved.
+          std::atomic<triton::usize> inflight;
+
+          //! Loop of a solver thread.
+          void work(void);
+
+        public:
+          //! Constructor.
+          SolverPool();
+
+          //! Destructor.
+          ~SolverPool();
+
+          //! Start the given number of solver threads, none without the Z3 interface.
+          void start(triton::usize nbthreads);
+
+          //! Solve the remaining jobs and join the threads.
+          void stop(void);
+
+          //! Queue a query. The node is converted here, the caller may keep using it.
+          void submit(SolverJob job);
+
+          //! Number of queued jobs.
+          triton::usize queueDepth(void);
+
+          //! Number of jobs being solved.
+          triton::usize inFlight(void) const;
+
+          //! True if the pool has threads.
+          bool isRunning(void) const;
+
+#ifdef TRITON_Z3_INTERFACE
+          //! Enumerate up to limit models of the solver assertions, each one blocked for the next. Variables are mapped back through converter.
+          static triton::engines::solver::status_e enumerate(z3::solver& solver, triton::ast::TritonToZ3& converter, triton::usize limit, Models& models);
+#endif
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_SOLVERPOOL_H */
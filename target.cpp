@@ -0,0 +1,161 @@
+#include <LIEF/ELF.hpp>
+#include <exception>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <triton/archEnums.hpp>
+#include <triton/ast.hpp>
+#include <triton/callbacks.hpp>
+#include <triton/callbacksEnums.hpp>
+#include <triton/context.hpp>
+#include <triton/cpuSize.hpp>
+#include <triton/exceptions.hpp>
+#include <triton/instruction.hpp>
+#include <triton/memoryAccess.hpp>
+#include <triton/modesEnums.hpp>
+#include <triton/register.hpp>
+
+#include "routines.hpp"
+#include "target.hpp"
+#include "utils.hpp"
+
+using namespace triton;
+
+#define RELOC_BASE 0x10000000
+#define STACK_BASE 0x9FFFFFFF
+
+// __COUNTER__ used to determine hook-function in callback
+#define HANDLER(name)                                                          \
+  {                                                                            \
+#name, {                                                                   \
+      ROUTINE, RELOC_BASE + __COUNTER__ *size::dword, triton::routines::name   \
+    }                                                                          \
+  }
+
+enum plt_type { ROUTINE = 0, LIBC_CUSTOM };
+
+struct plt_info {
+  triton::uint8 type;
+  triton::uint64 addr;
+  triton::engines::exploration::instCallback cb;
+};
+
+// add relocation or symbol you would like to hook
+std::map<std::string, plt_info> custom_plt{HANDLER(__libc_start_main),
+                                           HANDLER(printf),
+                                           HANDLER(fprintf),
+                                           HANDLER(sprintf),
+                                           HANDLER(snprintf),
+                                           HANDLER(puts),
+                                           HANDLER(fflush),
+                                           HANDLER(getlogin),
+                                           HANDLER(usleep),
+                                           HANDLER(putchar),
+                                           HANDLER(exit),
+                                           HANDLER(malloc),
+                                           HANDLER(calloc),
+                                           HANDLER(realloc),
+                                           HANDLER(free),
+                                           HANDLER(strlen),
+                                           HANDLER(strcmp),
+                                           HANDLER(strncmp),
+                                           HANDLER(memcmp),
+                                           HANDLER(memcpy),
+                                           HANDLER(memset),
+                                           HANDLER(strchr),
+                                           HANDLER(fgets)};
+
+void patchExection(Context *ctx, const LIEF::ELF::Binary *bin) {
+  for (const LIEF::Relocation rel : bin->relocations()) {
+    auto addr = rel.address();
+    auto symb = bin->get_relocation(addr)->symbol();
+    if (symb == nullptr)
+      continue;
+
+    auto name = symb->name();
+    auto check_hook = [=](std::pair<std::string, plt_info> i) {
+      return i.first == name;
+    };
+    auto hook = std::find_if(custom_plt.begin(), custom_plt.end(), check_hook);
+    if (hook == custom_plt.end())
+      continue;
+
+    triton_printf("[i] Replacing reloc %s\n", name.data());
+    arch::MemoryAccess mem(addr, ctx->getGprSize());
+    ctx->setConcreteMemoryValue(mem, hook->second.addr);
+  }
+  for (const LIEF::Symbol symb : bin->symbols()) {
+    auto addr = symb.value();
+    if (addr == 0)
+      continue;
+
+    auto name = symb.name();
+    auto check_hook = [=](std::pair<std::string, plt_info> i) {
+      return i.first == name;
+    };
+    auto hook = std::find_if(custom_plt.begin(), custom_plt.end(), check_hook);
+    if (hook == custom_plt.end())
+      continue;
+
+    triton_printf("[i] Replacing symb %s\n", name.data());
+    arch::MemoryAccess mem(addr, ctx->getGprSize());
+    ctx->setConcreteMemoryValue(mem, hook->second.addr);
+  }
+}
+
+uint64_t loadExec(Context *ctx, std::string str) {
+  auto bin = LIEF::ELF::Parser::parse(str);
+  if (bin == nullptr)
+    throw std::invalid_argument("Cannot parse binary");
+
+  for (LIEF::Section sect : bin->sections()) {
+    uint64 addr = sect.virtual_address(); // + 0x400000; // for windows
+    uint64 size = sect.size();
+    auto mem = bin->get_content_from_virtual_address(addr, size);
+    triton_printf("[+] Mapping %#08zx-%#08zx\n", addr, addr + size);
+    ctx->setConcreteMemoryAreaValue(addr, mem);
+  }
+
+  patchExection(ctx, bin.get()); // bind our hooks
+  return bin->entrypoint();
+}
+
+void initTriton(Context *ctx) {
+  ctx->setArchitecture(arch::ARCH_X86_64);
+  ctx->setMode(modes::ALIGNED_MEMORY, true);
+  ctx->setMode(modes::AST_OPTIMIZATIONS, true);
+  ctx->setMode(modes::CONSTANT_FOLDING, true);
+  // ctx->setMode(modes::MEMORY_ARRAY,
+  //              true); // use smt for bitvectors & array(another way only bv)
+     ctx->setMode(modes::ONLY_ON_SYMBOLIZED, true);
+  // ctx->setMode(modes::PC_TRACKING_SYMBOLIC, true);
+
+  ctx->setAstRepresentationMode(ast::representations::SMT_REPRESENTATION);
+
+  // setup fake stack regs
+  setGpr(ctx, GPR_SP, STACK_BASE);
+  setGpr(ctx, GPR_BP, STACK_BASE);
+}
+
+// add symbolic for memory
+void symbolize(Context *ctx) {
+  ctx->symbolizeMemory(0x9fffff40, 0x32);
+}
+
+void loadTarget(Context *ctx, const std::string &path) {
+  initTriton(ctx);
+
+  uint64 entrypoint = loadExec(ctx, path);
+  auto reg = ctx->getRegister(getGprId(ctx, GPR_IP));
+  ctx->setConcreteRegisterValue(reg, entrypoint);
+  symbolize(ctx);
+}
+
+void hookTarget(engines::exploration::SymbolicExplorator &explorator) {
+  for (auto plt : custom_plt) {
+    if (plt.second.type == ROUTINE)
+      explorator.hookInstruction(plt.second.addr, plt.second.cb,
+                                 engines::exploration::HOOK_PRE, plt.first);
+  }
+}
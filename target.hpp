@@ -0,0 +1,20 @@
+#ifndef KRACKME_TARGET_H
+#define KRACKME_TARGET_H
+
+#include <string>
+#include <triton/context.hpp>
+
+#include "ttexplore.hpp"
+
+using namespace triton;
+
+// the "Congratulations !!" block of krackme_1.out, reached with the flag
+constexpr uint64 KRACKME_SUCCESS = 0x18d2;
+
+// load the crackme in ctx, ready to run from its entrypoint with the flag
+// buffer symbolized
+void loadTarget(Context *ctx, const std::string &path);
+// hook the emulated libc routines
+void hookTarget(engines::exploration::SymbolicExplorator &explorator);
+
+#endif // KRACKME_TARGET_H
@@ -0,0 +1,289 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <stdlib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <triton/context.hpp>
+#include <vector>
+
+#include "corpusstore.hpp"
+#include "format.hpp"
+#include "heap.hpp"
+#include "querycache.hpp"
+#include "routines.hpp"
+#include "utils.hpp"
+
+/*
+ * Unit tests of the parts that do not need an exploration: the guest printf,
+ * the guest heap, the memory routines, the query cache and the corpus store.
+ * Run by ctest, the exit code is the number of failed checks.
+ */
+
+using namespace triton;
+using namespace triton::engines::exploration;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, int line) {
+  if (!ok) {
+    std::fprintf(stderr, "tests.cpp:%d: check failed: %s\n", line, what);
+    failures++;
+  }
+}
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+// guest layout of the printf tests
+constexpr uint64 FMT = 0x1000;
+constexpr uint64 OUT = 0x2000;
+constexpr uint64 SP = 0x7000;
+
+static void setReg(Context &ctx, arch::register_e id, uint64 value) {
+  ctx.setConcreteRegisterValue(ctx.getRegister(id), value);
+}
+
+static void setDouble(Context &ctx, int xmm, double value) {
+  uint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  setReg(ctx, static_cast<arch::register_e>(arch::ID_REG_X86_XMM0 + xmm),
+         bits);
+}
+
+// printf(fmt, ...) with the arguments already in place
+static std::string format(Context &ctx, const std::string &fmt) {
+  ctx.setConcreteMemoryAreaValue(FMT, fmt.c_str(), fmt.size() + 1);
+  setReg(ctx, arch::ID_REG_X86_RDI, FMT);
+  std::string out;
+  auto n = formatGuest(&ctx, FMT, 1, out);
+  CHECK(n == out.size());
+  return out;
+}
+
+static void testFormat(void) {
+  Context ctx(arch::ARCH_X86_64);
+  setGpr(&ctx, GPR_SP, SP);
+
+  CHECK(printfArgAmount("%d %s %%") == 2);
+
+  setReg(ctx, arch::ID_REG_X86_RSI, static_cast<uint64>(-5));
+  setReg(ctx, arch::ID_REG_X86_RDX, 0x1ff);
+  CHECK(format(ctx, "%d %hhx %5s|") == "-5 ff (null)|");
+
+  /* %hhn, %hn, %n and %ln store 1, 2, 4 and 8 bytes */
+  const char *sizes[] = {"%hhn", "%hn", "%n", "%ln"};
+  const uint64 widths[] = {1, 2, 4, 8};
+  for (int i = 0; i < 4; i++) {
+    std::vector<uint8> fill(16, 0xaa);
+    ctx.setConcreteMemoryAreaValue(OUT, fill);
+    setReg(ctx, arch::ID_REG_X86_RSI, OUT);
+    CHECK(format(ctx, std::string("abc") + sizes[i]) == "abc");
+    auto mem = ctx.getConcreteMemoryAreaValue(OUT, 16);
+    CHECK(mem[0] == 3);
+    for (uint64 j = 1; j < 16; j++)
+      CHECK(mem[j] == (j < widths[i] ? 0 : 0xaa));
+  }
+
+  /* The 9th double goes to the stack, the next integer still to rsi */
+  for (int i = 0; i < 8; i++)
+    setDouble(ctx, i, i + 1.5);
+  setReg(ctx, arch::ID_REG_X86_RSI, 7);
+  double ninth = 9.5;
+  ctx.setConcreteMemoryAreaValue(getArgAddr(&ctx, ARG_REGS), &ninth,
+                                 sizeof(ninth));
+
+  /* then a long double in the next 16-byte aligned slot: 2.25 as x87 */
+  uint8 x87[10] = {0, 0, 0, 0, 0, 0, 0, 0x90, 0x00, 0x40};
+  ctx.setConcreteMemoryAreaValue(getArgAddr(&ctx, ARG_REGS + 2), x87,
+                                 sizeof(x87));
+  CHECK(format(ctx, "%.1f %.1f %.1f %.1f %.1f %.1f %.1f %.1f %.1f "
+                    "%d %.2Lf") ==
+        "1.5 2.5 3.5 4.5 5.5 6.5 7.5 8.5 9.5 7 2.25");
+}
+
+static void testHeap(void) {
+  Context ctx(arch::ARCH_X86_64);
+  GuestHeap heap;
+  heap.attach(&ctx, true);
+
+  /* Sizes that would wrap the rounding */
+  CHECK(heap.malloc(static_cast<uint64>(-1)) == 0);
+  CHECK(heap.malloc(HEAP_SIZE + 1) == 0);
+  CHECK(heap.calloc(static_cast<uint64>(-1), 2) == 0);
+
+  auto a = heap.malloc(10);
+  auto b = heap.malloc(10);
+  auto big = heap.malloc(0x2345);
+  CHECK(a >= HEAP_BASE && a < HEAP_BASE + HEAP_SIZE);
+  CHECK(b != 0 && b != a);
+  CHECK(big != 0 && (big - HEAP_REDZONE) % 0x1000 == 0);
+  CHECK(heap.chunks() == 3);
+  CHECK(heap.check() == 0);
+
+  /* realloc keeps the bytes, a failed one keeps the chunk */
+  ctx.setConcreteMemoryAreaValue(a, "0123456789", 10);
+  CHECK(heap.realloc(a, static_cast<uint64>(-1)) == 0);
+  CHECK(heap.chunks() == 3);
+  auto c = heap.realloc(a, 100);
+  CHECK(c != 0);
+  CHECK(readBytes(&ctx, c, 10).data == "0123456789");
+  CHECK(heap.chunks() == 3);
+
+  /* mark() and reset() rewind the bookkeeping */
+  heap.mark();
+  CHECK(heap.free(b));
+  CHECK(!heap.free(b));
+  CHECK(heap.check() == 1);
+  heap.reset();
+  CHECK(heap.chunks() == 3);
+  CHECK(heap.check() == 0);
+
+  /* One byte past a chunk damages its redzone */
+  ctx.setConcreteMemoryValue(b + 10, 0);
+  CHECK(heap.check() == 1);
+  CHECK(heap.free(big));
+  CHECK(heap.malloc(0x2000) == big);
+}
+
+// routine(a, b, len), true if it refused the length
+static bool refused(Context &ctx,
+                    callbacks::cb_state_e (*routine)(Context *), uint64 len) {
+  setReg(ctx, arch::ID_REG_X86_RDI, OUT);
+  setReg(ctx, arch::ID_REG_X86_RSI, FMT);
+  setReg(ctx, arch::ID_REG_X86_RDX, len);
+  try {
+    routine(&ctx);
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+static void testRoutines(void) {
+  Context ctx(arch::ARCH_X86_64);
+  setGpr(&ctx, GPR_SP, SP);
+  ctx.setConcreteMemoryAreaValue(FMT, "abc", 4);
+  ctx.setConcreteMemoryAreaValue(OUT, "abd", 4);
+
+  /* A garbage length is refused before any host buffer is sized */
+  CHECK(refused(ctx, routines::memcpy, static_cast<uint64>(-1)));
+  CHECK(refused(ctx, routines::memcmp, static_cast<uint64>(-1)));
+
+  /* strncmp stops at the strings, a large n is fine */
+  CHECK(!refused(ctx, routines::strncmp, static_cast<uint64>(-1)));
+  CHECK(getGpr(&ctx, GPR_RET) == 1);
+
+  CHECK(!refused(ctx, routines::memcpy, 3));
+  CHECK(readBytes(&ctx, OUT, 3).data == "abc");
+}
+
+static void testQueryCache(void) {
+  Context ctx(arch::ARCH_X86_64);
+  auto ast = ctx.getAstContext();
+  auto x = ast->variable(ctx.symbolizeMemory(arch::MemoryAccess(FMT, 1)));
+  auto is = [&](uint64 v) { return ast->equal(x, ast->bv(v, 8)); };
+
+  /* A prefix extended branch by branch keys like the whole query */
+  QueryPrefix prefix;
+  prefix.add(is(1));
+  auto branch = prefix.key(is(2));
+  auto whole = QueryCache::key(ast->land(is(2), is(1)));
+  CHECK(branch.valid && branch.hash == whole.hash);
+  CHECK(branch.conjuncts == whole.conjuncts);
+
+  /* A full cache evicts the answer not used since the hand passed it */
+  const auto unsat = engines::solver::UNSAT;
+  std::vector<engines::symbolic::SharedSymbolicVariable> vars;
+  engines::solver::status_e status;
+  Models models;
+  QueryCache cache;
+  auto lookup = [&](const QueryKey &key) {
+    return cache.lookup(key, 1, vars, status, models,
+                        [](const Models &) { return false; });
+  };
+  cache.reset(2);
+  auto a = QueryCache::key(is(1));
+  auto b = QueryCache::key(is(2));
+  auto c = QueryCache::key(is(3));
+  cache.insert(a, 1, unsat, {});
+  cache.insert(b, 1, unsat, {});
+  CHECK(lookup(a) && status == unsat);
+  cache.insert(c, 1, unsat, {});
+  CHECK(cache.size() == 2 && cache.evicted() == 1);
+  CHECK(lookup(a) && !lookup(b) && lookup(c));
+}
+
+static std::vector<uint8> seedOf(const CorpusReader &reader, usize i) {
+  auto data = reader.seed(i);
+  return std::vector<uint8>(data, data + reader.entry(i).length);
+}
+
+static void testCorpusStore(void) {
+  auto tmp =
+      (std::filesystem::temp_directory_path() / "tests-XXXXXX").string();
+  if (!mkdtemp(&tmp[0])) {
+    CHECK(!"mkdtemp");
+    return;
+  }
+
+  const Seed s1 = {'a', 'b', 'c'};
+  const Seed s2 = {'d', 'e'};
+  const Seed s3 = {'f', 'g', 'h', 'i'};
+  {
+    CorpusStore store;
+    store.open(tmp);
+    CHECK(store.append(s1, 1, true));
+    CHECK(store.append(s2, 2, false));
+    CHECK(!store.append(s1, 3, true));
+    CHECK(store.size() == 2);
+    CHECK(store.dropped() == 1);
+  }
+  {
+    CorpusReader reader;
+    reader.open(tmp);
+    CHECK(reader.size() == 2);
+    CHECK(seedOf(reader, 0) == s1);
+    CHECK(seedOf(reader, 1) == s2);
+    CHECK(reader.entry(1).exec == 2 && reader.entry(1).novel == 0);
+  }
+
+  /* A crash tore the last entry and its data, reopening cuts them */
+  {
+    std::ofstream(tmp + "/" + CORPUS_INDEX_FILE, std::ios::app) << "torn";
+    std::ofstream(tmp + "/" + CORPUS_DATA_FILE, std::ios::app) << "xyz";
+    CorpusStore store;
+    store.open(tmp);
+    CHECK(store.size() == 2);
+    CHECK(!store.append(s2, 4, true));
+    CHECK(store.append(s3, 5, true));
+  }
+  {
+    CorpusReader reader;
+    reader.open(tmp);
+    CHECK(reader.size() == 3);
+    CHECK(seedOf(reader, 0) == s1);
+    CHECK(seedOf(reader, 2) == s3);
+    CHECK(reader.entry(2).exec == 5);
+  }
+
+  std::filesystem::remove_all(tmp);
+}
+
+int main(void) {
+  testFormat();
+  testHeap();
+  testRoutines();
+  testQueryCache();
+  testCorpusStore();
+  if (failures == 0)
+    std::printf("all tests passed\n");
+  return failures;
+}
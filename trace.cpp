@@ -0,0 +1,211 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+
+#include <triton/exceptions.hpp>
+
+#include "trace.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0,
+              "TRACE_RING_SIZE is a power of two");
+
+TraceRing::TraceRing()
+    : events(new TraceEvent[TRACE_RING_SIZE]), head(0), cachedTail(0),
+      tail(0), lost(0) {}
+
+triton::usize TraceRing::drain(std::FILE *file) {
+  const auto t = this->tail.load(std::memory_order_relaxed);
+  const auto h = this->head.load(std::memory_order_acquire);
+  if (h == t) {
+    return 0;
+  }
+
+  /* At most two spans, before and after the wrap */
+  const auto first = t & (TRACE_RING_SIZE - 1);
+  const auto count = h - t;
+  const auto span = std::min(count, TRACE_RING_SIZE - first);
+  std::fwrite(&this->events[first], sizeof(TraceEvent), span, file);
+  if (span < count) {
+    std::fwrite(&this->events[0], sizeof(TraceEvent), count - span, file);
+  }
+
+  this->tail.store(h, std::memory_order_release);
+  return count;
+}
+
+triton::uint64 TraceRing::dropped(void) const {
+  return this->lost.load(std::memory_order_relaxed);
+}
+
+Tracer::~Tracer() { this->close(); }
+
+void Tracer::open(
+    const std::string &path, triton::usize workers,
+    const std::vector<std::pair<triton::uint64, std::string>> &hooks) {
+  this->close();
+  this->rings.clear();
+
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path());
+  this->file = std::fopen(path.c_str(), "wb");
+  if (this->file == nullptr) {
+    throw triton::exceptions::Engines("Tracer::open(): Cannot create " +
+                                      path + ".");
+  }
+
+  /* Header: magic, then the hooks by id so that the decoder can name them */
+  const triton::uint64 nhooks = hooks.size();
+  std::fwrite(&TRACE_MAGIC, sizeof(TRACE_MAGIC), 1, this->file);
+  std::fwrite(&nhooks, sizeof(nhooks), 1, this->file);
+  for (const auto &hook : hooks) {
+    const triton::uint64 length = hook.second.size();
+    std::fwrite(&hook.first, sizeof(hook.first), 1, this->file);
+    std::fwrite(&length, sizeof(length), 1, this->file);
+    std::fwrite(hook.second.data(), 1, length, this->file);
+  }
+
+  for (triton::usize i = 0; i < workers; i++) {
+    this->rings.push_back(std::make_unique<TraceRing>());
+  }
+  this->stopping = false;
+  this->drainer = std::thread(&Tracer::drainLoop, this);
+}
+
+void Tracer::drainLoop(void) {
+  std::unique_lock<std::mutex> guard(this->lock);
+  while (!this->stopping) {
+    this->wake.wait_for(guard,
+                        std::chrono::milliseconds(TRACE_DRAIN_PERIOD));
+    guard.unlock();
+    for (auto &ring : this->rings) {
+      ring->drain(this->file);
+    }
+    guard.lock();
+  }
+}
+
+void Tracer::close(void) {
+  if (this->file == nullptr) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->stopping = true;
+  }
+  this->wake.notify_one();
+  this->drainer.join();
+
+  /* The producers are done, take what is left */
+  for (auto &ring : this->rings) {
+    ring->drain(this->file);
+  }
+  std::fclose(this->file);
+  this->file = nullptr;
+}
+
+TraceRing *Tracer::ring(triton::usize worker) {
+  return worker < this->rings.size() ? this->rings[worker].get() : nullptr;
+}
+
+triton::uint64 Tracer::dropped(void) const {
+  triton::uint64 n = 0;
+  for (const auto &ring : this->rings) {
+    n += ring->dropped();
+  }
+  return n;
+}
+
+triton::usize Tracer::decode(const std::string &path, std::ostream &out) {
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    throw triton::exceptions::Engines("Tracer::decode(): Cannot open " +
+                                      path + ".");
+  }
+
+  triton::uint64 magic = 0;
+  triton::uint64 nhooks = 0;
+  if (std::fread(&magic, sizeof(magic), 1, file) != 1 ||
+      magic != TRACE_MAGIC ||
+      std::fread(&nhooks, sizeof(nhooks), 1, file) != 1) {
+    std::fclose(file);
+    throw triton::exceptions::Engines("Tracer::decode(): Invalid trace " +
+                                      path + ".");
+  }
+
+  std::vector<std::pair<triton::uint64, std::string>> hooks(nhooks);
+  for (auto &hook : hooks) {
+    triton::uint64 length = 0;
+    if (std::fread(&hook.first, sizeof(hook.first), 1, file) != 1 ||
+        std::fread(&length, sizeof(length), 1, file) != 1) {
+      std::fclose(file);
+      throw triton::exceptions::Engines("Tracer::decode(): Truncated trace " +
+                                        path + ".");
+    }
+    hook.second.resize(length);
+    if (std::fread(hook.second.data(), 1, length, file) != length) {
+      std::fclose(file);
+      throw triton::exceptions::Engines("Tracer::decode(): Truncated trace " +
+                                        path + ".");
+    }
+  }
+
+  /* A torn last event is ignored */
+  triton::usize n = 0;
+  TraceEvent buffer[4096];
+  triton::usize count;
+  while ((count = std::fread(buffer, sizeof(TraceEvent), 4096, file)) > 0) {
+    for (triton::usize i = 0; i < count; i++) {
+      const auto payload = buffer[i] & 0xffffffffffff;
+      const auto size = (buffer[i] >> 48) & 0xf;
+      const auto kind = (buffer[i] >> 52) & 0xf;
+      const auto worker = buffer[i] >> 56;
+
+      out << "[w" << std::dec << worker << "] ";
+      switch (kind) {
+      case TRACE_INST:
+        out << "0x" << std::hex << payload << std::dec << " (" << size
+            << " bytes)";
+        break;
+      case TRACE_HOOK_PRE:
+      case TRACE_HOOK_POST:
+        out << (kind == TRACE_HOOK_PRE ? "hook pre " : "hook post ");
+        if (payload < hooks.size()) {
+          out << (hooks[payload].second.empty() ? "-"
+                                                : hooks[payload].second)
+              << " 0x" << std::hex << hooks[payload].first << std::dec;
+        } else {
+          out << "#" << payload;
+        }
+        break;
+      case TRACE_EXEC:
+        out << "exec " << payload;
+        break;
+      case TRACE_END:
+        out << "end, " << payload << " instructions";
+        break;
+      default:
+        out << "unknown event 0x" << std::hex << buffer[i] << std::dec;
+        break;
+      }
+      out << "\n";
+    }
+    n += count;
+  }
+
+  std::fclose(file);
+  return n;
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
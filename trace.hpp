@@ -0,0 +1,184 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_TRACE_H
+#define TRITON_TRACE_H
+
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      //! Name of the trace file in the workspace.
+      constexpr const char* TRACE_FILE = "trace.bin";
+
+      //! Magic of the trace file.
+      constexpr triton::uint64 TRACE_MAGIC = 0x3130454341525454; /* "TTRACE01" */
+
+      //! Events per worker ring, a power of two.
+      constexpr triton::usize TRACE_RING_SIZE = 1 << 20;
+
+      //! Period of the drain thread (ms).
+      constexpr triton::usize TRACE_DRAIN_PERIOD = 10;
+
+      //! Kind of a trace event.
+      enum trace_e {
+        TRACE_INST = 0,  //!< An instruction, the payload is its address.
+        TRACE_HOOK_PRE,  //!< A pre hook, the payload is its id.
+        TRACE_HOOK_POST, //!< A post hook, the payload is its id.
+        TRACE_EXEC,      //!< Start of an execution, the payload is its number.
+        TRACE_END,       //!< End of an execution, the payload is its instruction count.
+      };
+
+      /*! \brief An event, packed in 8 bytes.
+
+          bits 0-47 payload, bits 48-51 opcode size, bits 52-55 kind,
+          bits 56-63 worker. */
+      using TraceEvent = triton::uint64;
+
+      //! Pack an event.
+      inline TraceEvent traceEvent(trace_e kind, triton::usize worker, triton::uint64 payload, triton::uint32 size = 0) {
+        return (payload & 0xffffffffffff) | (static_cast<triton::uint64>(size & 0xf) << 48) |
+               (static_cast<triton::uint64>(kind) << 52) | (static_cast<triton::uint64>(worker & 0xff) << 56);
+      }
+
+      /*! \class TraceRing
+          \brief Single producer, single consumer ring of events.
+
+          The worker pushes, the drain thread pops. A full ring drops the
+          event rather than wait. */
+      class TraceRing {
+        private:
+          //! Events, TRACE_RING_SIZE of them.
+          std::unique_ptr<TraceEvent[]> events;
+
+          //! Next slot to write, owned by the producer.
+          alignas(64) std::atomic<triton::usize> head;
+
+          //! Last tail seen by the producer.
+          triton::usize cachedTail;
+
+          //! Next slot to read, owned by the consumer.
+          alignas(64) std::atomic<triton::usize> tail;
+
+          //! Events dropped on a full ring.
+          std::atomic<triton::uint64> lost;
+
+        public:
+          //! Constructor.
+          TraceRing();
+
+          //! Record an event.
+          inline void push(TraceEvent event) {
+            const auto h = this->head.load(std::memory_order_relaxed);
+            if (h - this->cachedTail >= TRACE_RING_SIZE) {
+              this->cachedTail = this->tail.load(std::memory_order_acquire);
+              if (h - this->cachedTail >= TRACE_RING_SIZE) {
+                this->lost.fetch_add(1, std::memory_order_relaxed);
+                return;
+              }
+            }
+            this->events[h & (TRACE_RING_SIZE - 1)] = event;
+            this->head.store(h + 1, std::memory_order_release);
+          }
+
+          //! Write the pending events to a file, returns their number.
+          triton::usize drain(std::FILE* file);
+
+          //! Events dropped so far.
+          triton::uint64 dropped(void) const;
+      };
+
+      /*! \class Tracer
+          \brief Per-worker trace rings and the thread writing them to disk.
+
+          The file is the magic, the hook table, then the events as written
+          by the drain thread: ordered by worker, interleaved between
+          workers. */
+      class Tracer {
+        private:
+          //! Rings, by worker.
+          std::vector<std::unique_ptr<TraceRing>> rings;
+
+          //! Trace file.
+          std::FILE* file = nullptr;
+
+          //! Drain thread.
+          std::thread drainer;
+
+          //! Protects stopping.
+          std::mutex lock;
+
+          //! Wakes the drain thread up.
+          std::condition_variable wake;
+
+          //! True when the drain thread must exit.
+          bool stopping = false;
+
+          //! Drain thread loop.
+          void drainLoop(void);
+
+        public:
+          //! Destructor.
+          ~Tracer();
+
+          //! Create the file and the rings, start the drain thread. hooks are <address, name> by hook id.
+          void open(const std::string& path, triton::usize workers, const std::vector<std::pair<triton::uint64, std::string>>& hooks);
+
+          //! Stop the drain thread, flush the rings and close the file.
+          void close(void);
+
+          //! Ring of a worker, nullptr if not tracing.
+          TraceRing* ring(triton::usize worker);
+
+          //! Events dropped by all rings.
+          triton::uint64 dropped(void) const;
+
+          //! Print a trace file as text, returns the number of events.
+          static triton::usize decode(const std::string& path, std::ostream& out);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_TRACE_H */
@@ -0,0 +1,26 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include <exception>
+#include <iostream>
+
+#include "trace.hpp"
+
+/* Print a binary trace as text */
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " <trace file>" << std::endl;
+    return 1;
+  }
+
+  try {
+    auto n = triton::engines::exploration::Tracer::decode(argv[1], std::cout);
+    std::cerr << n << " events" << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
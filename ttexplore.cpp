@@ -4,35 +4,66 @@
 **  Jonathan Salwan
 */
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <triton/aarch64Cpu.hpp>
 #include <triton/arm32Cpu.hpp>
 #include <triton/coreUtils.hpp>
+#include <triton/cpuSize.hpp>
 #include <triton/exceptions.hpp>
+#include <triton/modesEnums.hpp>
+#include <triton/symbolicEnums.hpp>
 #include <triton/x8664Cpu.hpp>
 #include <triton/x86Cpu.hpp>
 
 #include "ttexplore.hpp"
-
-extern bool DEBUG;
+#include "utils.hpp"
 
 namespace triton {
 namespace engines {
 namespace exploration {
 
+thread_local Worker *SymbolicExplorator::current = nullptr;
+
 SymbolicExplorator::SymbolicExplorator() {
   this->config.ea_model = 1000;
+  this->config.ea_strategy = EA_STRATEGY_SAMPLE;
+  this->config.ea_samples = 8;
+  this->config.ea_array_range = 256;
+  this->config.ea_probes = 24;
   this->config.jmp_model = 1000;
   this->config.limit_inst = 0;
   this->config.stats = true;
+  this->config.stats_interval = 1;
   this->config.timeout = 60;
   this->config.end_point = 0;
+  this->config.workers = 1;
+  this->config.solver_threads = 0;
+  this->config.dirty_restore = true;
+  this->config.decode_cache = true;
+  this->config.slicing = true;
+  this->config.incremental = false;
+  this->config.schedule = SCHEDULE_DFS;
+  this->config.restart_interval = 64;
+  this->config.rng_seed = 0;
+  this->config.target = 0;
+  this->config.checkpoint_interval = 0;
+  this->config.resume = false;
+  this->config.heap_redzones = false;
+  this->config.quiet = false;
+  this->config.trace = false;
+  this->config.query_cache = 1 << 16;
+  this->config.query_cache_persist = false;
+  this->config.reuse_candidates = 16;
 
   this->bck_ctx = nullptr;
   this->ini_ctx = nullptr;
@@ -40,6 +71,15 @@ SymbolicExplorator::SymbolicExplorator() {
   this->nbsat = 0;
   this->nbtimeout = 0;
   this->nbunsat = 0;
+  this->solved = false;
+  this->solutionExec = 0;
+  this->solutionTime = 0;
+  this->lastCheckpoint = 0;
+  this->ckptOpen = false;
+  this->slicedKept = 0;
+  this->slicedTotal = 0;
+  this->reuseTried = 0;
+  this->reuseHits = 0;
 }
 
 SymbolicExplorator::SymbolicExplorator(triton::Context *ini_ctx)
@@ -57,9 +97,24 @@ void SymbolicExplorator::initContext(triton::Context *ini_ctx) {
 }
 
 void SymbolicExplorator::initWorklist(void) {
+  std::filesystem::create_directories(config.workspace + "/coverage");
+  this->corpus.open(config.workspace + "/corpus");
+  this->crashes.open(config.workspace + "/crashes");
+  this->outputs.open(config.workspace + "/outputs");
+
+  if (this->config.resume && this->resume()) {
+    return;
+  }
+
   triton::engines::solver::status_e status;
+  auto start = std::chrono::steady_clock::now();
   auto model = this->ini_ctx->getModel(this->ini_ctx->getPathPredicate(),
                                        &status, this->config.timeout);
+  this->metrics.answered(SOURCE_SOLVER);
+  this->metrics.solved(
+      status, std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count());
   if (status == triton::engines::solver::SAT) {
     this->nbsat++;
     /* If the model is SAT and empty, it means that any values satisfy the path
@@ -70,22 +125,20 @@ void SymbolicExplorator::initWorklist(void) {
             triton::engines::solver::SolverModel(item.second, 0x01);
       }
     }
-    this->worklist.push_back(model);
+    this->worklist.push(0,
+                        SeedEntry{this->layout.fromModel(model), 0, true, 0});
   } else if (status == triton::engines::solver::TIMEOUT) {
     this->nbtimeout++;
   } else {
     this->nbunsat++;
   }
-  std::filesystem::create_directories(config.workspace + "/corpus");
-  std::filesystem::create_directories(config.workspace + "/crashes");
-  std::filesystem::create_directories(config.workspace + "/coverage");
 }
 
 void SymbolicExplorator::dumpCoverage(void) {
   std::ofstream f;
   f.open(this->config.workspace + "/coverage/ida_cov.py");
-  for (const auto &item : this->coverage) {
-    f << std::hex << "idc.set_color(0x" << item.first
+  for (const auto &addr : this->coverage.instructionList()) {
+    f << std::hex << "idc.set_color(0x" << addr
       << ", idc.CIC_ITEM, 0x024701)" << std::endl;
   }
   f.close();
@@ -93,22 +146,12 @@ void SymbolicExplorator::dumpCoverage(void) {
             << this->config.workspace << "/coverage/ida_cov.py" << std::endl;
 }
 
-void SymbolicExplorator::writeSeedOnDisk(const std::string &dir,
-                                         const Seed &seed) {
-  std::ofstream f;
-  auto v = this->seed2vector(seed);
-  f.open(this->config.workspace + "/" + dir + "/" +
-         std::to_string(this->nbexec));
-  f.write(reinterpret_cast<const char *>(v.data()), v.size());
-  f.close();
-}
-
-void SymbolicExplorator::asmret(void) {
-  switch (this->ini_ctx->getArchitecture()) {
+void SymbolicExplorator::asmret(Worker &w) {
+  switch (w.ctx->getArchitecture()) {
   case triton::arch::ARCH_X86:
   case triton::arch::ARCH_X86_64: {
     auto ret = triton::arch::Instruction("\xc3", 1);
-    this->ini_ctx->processing(ret);
+    w.ctx->processing(ret);
     break;
   }
   default:
@@ -117,14 +160,30 @@ void SymbolicExplorator::asmret(void) {
   }
 }
 
-void SymbolicExplorator::run(const Seed &seed) {
-  triton::arch::CpuInterface *cpu = this->ini_ctx->getCpuInstance();
+void SymbolicExplorator::run(Worker &w, const Seed &seed) {
+  triton::arch::CpuInterface *cpu = w.ctx->getCpuInstance();
 
   /* Init the program counter */
   triton::arch::Register pcreg = cpu->getProgramCounter();
   triton::uint64 pcval = 0;
   triton::usize count = 0;
 
+  /* Crashes are named after the execution, the corpus after the next one */
+  const triton::usize exec = this->nbexec++;
+
+  /* Empty path encoding */
+  w.pathHash = PATH_HASH_INIT;
+  w.pathLen = 0;
+  w.eaTime = 0;
+  w.eaCalls = 0;
+
+  /* Seeds found during the run do not know its novelty yet */
+  w.novel = false;
+  w.output.clear();
+  if (w.trace) {
+    w.trace->push(traceEvent(TRACE_EXEC, w.id, exec));
+  }
+
   do {
     if (this->config.limit_inst && count >= this->config.limit_inst) {
       break;
@@ -132,63 +191,130 @@ void SymbolicExplorator::run(const Seed &seed) {
 
     pcval = triton::utils::cast<triton::uint64>(
         cpu->getConcreteRegisterValue(pcreg));
-    if (this->instHooks.find(pcval) != this->instHooks.end()) {
-      auto state = this->instHooks.at(pcval)(this->ini_ctx);
+    auto hook = this->hooks.find(pcval);
+    if (hook != nullptr && hook->cb[HOOK_PRE]) {
+      if (w.trace) {
+        w.trace->push(traceEvent(TRACE_HOOK_PRE, w.id, hook->id));
+      }
+      auto state = this->hooks.call(*hook, HOOK_PRE, w.ctx);
       switch (state) {
       case triton::callbacks::CONTINUE:
-        continue;
+        break;
       case triton::callbacks::BREAK:
         goto stop_execution;
       case triton::callbacks::PLT_CONTINUE:
-        this->asmret();
-        continue;
+        this->asmret(w);
+        break;
+      }
+      if (hook->cb[HOOK_POST]) {
+        if (w.trace) {
+          w.trace->push(traceEvent(TRACE_HOOK_POST, w.id, hook->id));
+        }
+        if (this->hooks.call(*hook, HOOK_POST, w.ctx) ==
+            triton::callbacks::BREAK) {
+          goto stop_execution;
+        }
       }
+      continue;
     } else if (this->config.end_point && pcval == 0 ||
                cpu->isConcreteMemoryValueDefined(pcval, 1) == false) {
       std::cout << "[TT] Invalid control flow, pc = 0x" << std::hex << pcval
                 << " (writing seed on disk)" << std::endl;
-      this->writeSeedOnDisk("crashes", seed);
+      this->crashes.append(seed, exec, false);
       break;
     }
 
-    /* Fetch opcodes */
-    auto opcodes = this->ini_ctx->getConcreteMemoryAreaValue(pcval, 16);
+    /* Decode the instruction, or copy it from the decode cache */
+    triton::arch::Instruction inst;
+    auto cached =
+        this->config.decode_cache ? w.icache.lookup(pcval) : nullptr;
+    if (cached != nullptr) {
+      inst = *cached;
+    } else {
+      auto opcodes =
+          w.ctx->getConcreteMemoryAreaValue(pcval, DECODE_MAX_SIZE);
+      inst.setAddress(pcval);
+      inst.setOpcode(opcodes.data(), opcodes.size());
+      w.ctx->disassembly(inst);
+      if (this->config.decode_cache) {
+        w.icache.insert(inst);
+      }
+    }
 
     /* Execute instruction */
-    triton::arch::Instruction inst(pcval, opcodes.data(), opcodes.size());
-    if (this->ini_ctx->processing(inst) != triton::arch::NO_FAULT) {
+    if (w.ctx->buildSemantics(inst) != triton::arch::NO_FAULT) {
       if (inst.getDisassembly() != "hlt") {
         std::cout << "[TT] Invalid instruction, pc = 0x" << std::hex << pcval
                   << " (writing seed on disk)" << std::endl;
-        this->writeSeedOnDisk("crashes", seed);
+        this->crashes.append(seed, exec, false);
       }
       break;
     }
 
-    if (DEBUG)
-      std::cout << std::setw(15) << std::right << "| " << std::left << inst
-                << std::endl;
+    if (w.trace) {
+      w.trace->push(traceEvent(TRACE_INST, w.id, pcval, inst.getSize()));
+    }
+
+    this->symbolizeEffectiveAddress(w, inst);
 
-    this->symbolizeEffectiveAddress(inst);
+    /* Update the code coverage, a decoded instruction is also recorded */
+    w.edges.hit(pcval);
+    if (cached == nullptr) {
+      w.edges.decoded(pcval);
+    }
 
-    /* Update the code coverage */
-    if (this->coverage.find(pcval) != this->coverage.end()) {
-      this->coverage[pcval] += 1;
-    } else {
-      this->coverage[pcval] = 1;
+    if (pcval == this->config.target && this->config.target) {
+      this->reportSolution(exec);
+    }
+
+    if (hook != nullptr && hook->cb[HOOK_POST]) {
+      if (w.trace) {
+        w.trace->push(traceEvent(TRACE_HOOK_POST, w.id, hook->id));
+      }
+      if (this->hooks.call(*hook, HOOK_POST, w.ctx) ==
+          triton::callbacks::BREAK) {
+        break;
+      }
     }
 
     count++;
   } while (this->config.end_point != pcval);
 
 stop_execution:
-  this->nbexec += 1;
-  this->writeSeedOnDisk("corpus", seed);
+  this->metrics.executed(count);
+  if (w.eaCalls) {
+    this->metrics.add(PHASE_SYMBOLIZE_EA, w.eaTime, w.eaCalls);
+  }
+  if (w.trace) {
+    w.trace->push(traceEvent(TRACE_END, w.id, count));
+  }
+  if (w.heap.check()) {
+    std::cout << "[TT] Heap corruption (writing seed on disk)" << std::endl;
+    this->crashes.append(seed, exec, false);
+  }
+
+  /* Merge the coverage of this execution */
+  w.novel = this->coverage.merge(w.edges);
+
+  /* A new output is as good as a new edge */
+  const auto &output = w.output.data();
+  const auto outputHash = CorpusStore::hash(
+      reinterpret_cast<const triton::uint8 *>(output.data()), output.size());
+  if (this->outputs.append(output.data(), output.size(), exec + 1, true,
+                           outputHash)) {
+    w.novel = true;
+  }
+  if (!this->config.quiet && !output.empty()) {
+    std::lock_guard<std::mutex> guard(this->statLock);
+    std::fwrite(output.data(), 1, output.size(), stdout);
+    std::fflush(stdout);
+  }
+
+  this->corpus.append(seed, exec + 1, w.novel, outputHash);
 }
 
-void SymbolicExplorator::snapshotContext(triton::Context *dst,
-                                         triton::Context *src) {
-  /* Synch concrete state */
+void SymbolicExplorator::copyConcreteState(triton::Context *dst,
+                                           triton::Context *src) {
   switch (src->getArchitecture()) {
   case triton::arch::ARCH_X86_64:
     *static_cast<triton::arch::x86::x8664Cpu *>(dst->getCpuInstance()) =
@@ -211,8 +337,16 @@ void SymbolicExplorator::snapshotContext(triton::Context *dst,
     break;
   default:
     throw triton::exceptions::Engines(
-        "SymbolicExplorator::snapshotContext(): Invalid architecture");
+        "SymbolicExplorator::copyConcreteState(): Invalid architecture");
   }
+}
+
+void SymbolicExplorator::snapshotContext(triton::Context *dst,
+                                         triton::Context *src) {
+  auto start = std::chrono::steady_clock::now();
+
+  /* Synch concrete state */
+  this->copyConcreteState(dst, src);
 
   /* Synch symbolic register */
   dst->concretizeAllRegister();
@@ -221,7 +355,8 @@ void SymbolicExplorator::snapshotContext(triton::Context *dst,
                                             dst->getRegister(item.first));
   }
 
-  /* Synch symbolic memory */
+  /* Synch symbolic memory. Concretizing also drops the memory array, the
+   * stores of a run, the symbolic bytes below are stored in a fresh one. */
   dst->concretizeAllMemory();
   for (const auto &item : src->getSymbolicMemory()) {
     dst->assignSymbolicExpressionToMemory(
@@ -234,162 +369,772 @@ void SymbolicExplorator::snapshotContext(triton::Context *dst,
   for (const auto &pc : src->getPathConstraints()) {
     dst->pushPathConstraint(pc);
   }
+
+  this->metrics.add(PHASE_SNAPSHOT, start);
+}
+
+triton::Context *SymbolicExplorator::cloneContext(triton::Context *src) {
+  if (src->getPathConstraints().size()) {
+    throw triton::exceptions::Engines("SymbolicExplorator::cloneContext(): "
+                                      "Cannot clone a constrained context.");
+  }
+
+  auto dst = new triton::Context(src->getArchitecture());
+  for (auto mode : {triton::modes::ALIGNED_MEMORY,
+                    triton::modes::AST_OPTIMIZATIONS,
+                    triton::modes::CONSTANT_FOLDING,
+                    triton::modes::MEMORY_ARRAY,
+                    triton::modes::ONLY_ON_SYMBOLIZED,
+                    triton::modes::ONLY_ON_TAINTED,
+                    triton::modes::PC_TRACKING_SYMBOLIC,
+                    triton::modes::SYMBOLIZE_INDEX_ROTATION,
+                    triton::modes::TAINT_THROUGH_POINTERS}) {
+    dst->setMode(mode, src->isModeEnabled(mode));
+  }
+  dst->setAstRepresentationMode(src->getAstRepresentationMode());
+  dst->setSolver(src->getSolver());
+  this->copyConcreteState(dst, src);
+
+  /* Replay the symbolic variables in order so that ids (and thus seeds) are
+   * the same in every context */
+  const auto nbvars = src->getSymbolicVariables().size();
+  for (triton::usize i = 0; i < nbvars; i++) {
+    auto var = src->getSymbolicVariable(i);
+    switch (var->getType()) {
+    case triton::engines::symbolic::MEMORY_VARIABLE:
+      dst->symbolizeMemory(
+          triton::arch::MemoryAccess(var->getOrigin(),
+                                     var->getSize() / triton::bitsize::byte));
+      break;
+    case triton::engines::symbolic::REGISTER_VARIABLE:
+      dst->symbolizeRegister(dst->getRegister(
+          static_cast<triton::arch::register_e>(var->getOrigin())));
+      break;
+    default:
+      throw triton::exceptions::Engines(
+          "SymbolicExplorator::cloneContext(): Invalid variable type");
+    }
+  }
+
+  return dst;
+}
+
+void SymbolicExplorator::mergeModels(triton::usize lane,
+                                     triton::engines::solver::status_e status,
+                                     const Models &models, triton::uint64 time,
+                                     answer_source_e source,
+                                     triton::uint32 hits, bool novel,
+                                     const Seed *base,
+                                     ea_strategy_e strategy) {
+  /* Answers the solver did not give alone would skew its latencies */
+  const bool fromSolver = source == SOURCE_SOLVER;
+  this->metrics.answered(source);
+  if (fromSolver) {
+    this->metrics.solved(status, time);
+  }
+  if (strategy != EA_STRATEGY_COUNT) {
+    this->metrics.concretized(
+        strategy, status == triton::engines::solver::SAT ? models.size() : 0,
+        time);
+  }
+  if (status == triton::engines::solver::SAT) {
+    for (const auto &model : models) {
+      this->nbsat += fromSolver;
+      auto seed = base ? this->layout.fromModel(model, *base)
+                       : this->layout.fromModel(model);
+      this->worklist.push(lane, SeedEntry{std::move(seed), hits, novel, 0});
+    }
+  } else if (status == triton::engines::solver::TIMEOUT) {
+    this->nbtimeout += fromSolver;
+  } else {
+    this->nbunsat += fromSolver;
+  }
 }
 
-std::list<triton::uint64> SymbolicExplorator::buildPathAddrs(void) {
-  std::list<triton::uint64> pathaddrs;
-  for (const auto &pc : this->ini_ctx->getPathConstraints()) {
-    pathaddrs.push_back(pc.getSourceAddress());
+void SymbolicExplorator::solve(Worker &w,
+                               const triton::ast::SharedAbstractNode &node,
+                               triton::usize limit, triton::uint32 slot,
+                               bool fromSeed, ea_strategy_e strategy) {
+  /* What the scheduler will know about the new seeds */
+  const auto hits = this->coverage.slotHits(slot);
+  const auto novel = w.novel;
+  const Seed *base = fromSeed ? &w.task->entry.seed : nullptr;
+
+  /* Known answers, and queries holding a known UNSAT core, skip the solver */
+  QueryKey key;
+  if (this->queries.enabled()) {
+    triton::engines::solver::status_e status;
+    Models models;
+    key = QueryCache::key(node);
+    auto check = [&](const Models &m) { return this->satisfies(w, node, m); };
+    if (this->queries.lookup(key, limit, w.vars, status, models, check)) {
+      this->mergeModels(w.id, status, models, 0, SOURCE_CACHE, hits, novel,
+                        base, strategy);
+      return;
+    }
+  }
+
+  /* Synchronous mode, the emulation waits for the solver */
+  if (this->solver.isRunning() == false) {
+    triton::engines::solver::status_e status;
+    auto start = std::chrono::steady_clock::now();
+    auto models =
+        w.ctx->getModels(node, limit, &status, this->config.timeout);
+    const triton::uint64 time =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+    if (this->queries.enabled()) {
+      this->queries.insert(key, limit, status, models);
+    }
+    this->mergeModels(w.id, status, models, time, SOURCE_SOLVER, hits, novel,
+                      base, strategy);
+    return;
   }
-  return pathaddrs;
+
+  /* The worklist must not drain while the query is pending, and the seed
+   * must be checkpointed until it is answered */
+  this->worklist.retain();
+  auto task = w.task;
+  task->refs++;
+
+  SolverJob job;
+  job.node = node;
+  job.limit = limit;
+  job.timeout = this->config.timeout;
+  job.callback = [this, lane = w.id, hits, novel, task, limit, fromSeed,
+                  strategy, key = std::move(key)](
+                     triton::engines::solver::status_e status,
+                     const Models &models, triton::uint64 time) {
+    if (this->queries.enabled()) {
+      this->queries.insert(key, limit, status, models);
+    }
+    this->mergeModels(lane, status, models, time, SOURCE_SOLVER, hits, novel,
+                      fromSeed ? &task->entry.seed : nullptr, strategy);
+    this->closeTask(task);
+    this->worklist.release();
+  };
+  this->solver.submit(std::move(job));
+}
+
+void SymbolicExplorator::restoreContext(Worker &w) {
+  auto start = std::chrono::steady_clock::now();
+
+  if (this->config.dirty_restore) {
+    w.dirty.restore(w.bck);
+  } else {
+    this->snapshotContext(w.ctx, w.bck);
+  }
+  w.heap.reset();
+
+  this->metrics.add(PHASE_RESTORE, start);
+}
+
+triton::uint64 SymbolicExplorator::buildPathHash(Worker &w) {
+  /* Path constraints only grow during an execution, fold the new ones */
+  const auto &pcs = w.ctx->getPathConstraints();
+  for (; w.pathLen < pcs.size(); w.pathLen++) {
+    w.pathHash =
+        Donelist::extend(w.pathHash, pcs[w.pathLen].getSourceAddress());
+  }
+  return w.pathHash;
 }
 
 void SymbolicExplorator::symbolizeEffectiveAddress(
-    const triton::arch::Instruction &inst) {
-  triton::engines::solver::status_e status;
+    Worker &w, const triton::arch::Instruction &inst) {
   /* Iterate over operands */
   for (const auto &operand : inst.operands) {
     if (operand.getType() == triton::arch::OP_MEM) {
       auto ea = operand.getConstMemory().getLeaAst();
       auto addr = operand.getConstMemory();
       if (ea != nullptr && ea->isSymbolized()) {
-        auto ast = this->ini_ctx->getAstContext();
+        auto start = std::chrono::steady_clock::now();
+        auto ast = w.ctx->getAstContext();
         /* Build the path addrs encoding and check if we already asked for this
-         * model */
-        auto pathaddrs = this->buildPathAddrs();
-        pathaddrs.push_back(inst.getAddress());
-        if (this->donelist.find(pathaddrs) == this->donelist.end()) {
-          std::cout << "Pathaddrs: " << std::hex << inst.getAddress()
-                    << std::endl;
-          /* Adding the path encoding to the donelist */
-          this->donelist.insert(pathaddrs);
-          /* constraint := (pc && ea != ea.eval) */
-          auto c =
-              ast->land(this->ini_ctx->getPathPredicate(),
-                        ast->distinct(ea, ast->bv(ea->evaluate(),
-                                                  ea->getBitvectorSize())));
-          auto models = this->ini_ctx->getModels(c, this->config.ea_model,
-                                                 &status, this->config.timeout);
-          if (status == triton::engines::solver::SAT) {
-            for (auto model : models) {
-              this->nbsat++;
-              this->worklist.push_front(model);
-            }
-          } else if (status == triton::engines::solver::TIMEOUT) {
-            this->nbtimeout++;
-          } else {
-            this->nbunsat++;
+         * model. Adding it to the donelist in the same time. */
+        auto pathaddrs =
+            Donelist::extend(this->buildPathHash(w), inst.getAddress());
+        bool pin = true;
+        if (this->claim(w, pathaddrs)) {
+          debug_printf("Pathaddrs: %#zx\n", inst.getAddress());
+          pin = this->concretizeEffectiveAddress(w, inst, ea);
+          if (!pin) {
+            std::lock_guard<std::mutex> guard(this->eaLock);
+            this->eaArrays.insert(pathaddrs);
           }
+        } else if (this->config.ea_strategy == EA_STRATEGY_ARRAY) {
+          std::lock_guard<std::mutex> guard(this->eaLock);
+          pin = this->eaArrays.count(pathaddrs) == 0;
         }
         // Enforce the value of the EA into the current path predicate
-        this->ini_ctx->pushPathConstraint(
-            ast->equal(ea, ast->bv(ea->evaluate(), ea->getBitvectorSize())));
+        if (pin) {
+          w.ctx->pushPathConstraint(ast->equal(
+              ea, ast->bv(ea->evaluate(), ea->getBitvectorSize())));
+        }
+        w.eaTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        w.eaCalls++;
       }
     }
   }
 }
 
-void SymbolicExplorator::findNewInputs(void) {
-  triton::engines::solver::status_e status;
-  std::list<triton::uint64> pathaddrs;
-  auto pcs = this->ini_ctx->getPathConstraints();
-  auto ast = this->ini_ctx->getAstContext();
+bool SymbolicExplorator::concretizeEffectiveAddress(
+    Worker &w, const triton::arch::Instruction &inst,
+    const triton::ast::SharedAbstractNode &ea) {
+  auto ast = w.ctx->getAstContext();
+  const auto strategy = this->config.ea_strategy;
+  const auto slot =
+      EdgeTrace::slot(inst.getAddress(), inst.getAddress() + inst.getSize());
+
+  switch (strategy) {
+  case EA_STRATEGY_NONE:
+    this->metrics.concretized(strategy, 0, 0);
+    return true;
+
+  /* constraint := (pc && ea != ea.eval) */
+  case EA_STRATEGY_ALL:
+  case EA_STRATEGY_SAMPLE:
+    this->solve(w,
+                ast->land(w.ctx->getPathPredicate(),
+                          ast->distinct(ea, ast->bv(ea->evaluate(),
+                                                    ea->getBitvectorSize()))),
+                strategy == EA_STRATEGY_ALL ? this->config.ea_model
+                                            : this->config.ea_samples,
+                slot, false, strategy);
+    return true;
+
+  default:
+    break;
+  }
+
+  /* Range queries depend on each other, the worker waits for them */
+  EaConcretizer concretizer(w.ctx, w.ctx->getPathPredicate(), ea,
+                            this->config.timeout, this->config.ea_probes);
+  Models models;
+  triton::uint64 min = 0, max = 0;
+  if (concretizer.range(min, max, models)) {
+    if (strategy == EA_STRATEGY_PAGES) {
+      models.clear();
+      concretizer.pages(min, max, this->config.ea_samples, models);
+    }
+    /* A small range is left to the memory array, the loads of the path
+     * cover all of it */
+    else if (strategy == EA_STRATEGY_ARRAY &&
+             max - min < this->config.ea_array_range) {
+      this->metrics.concretized(strategy, 0, concretizer.getTime());
+      return false;
+    }
+  }
+  this->mergeModels(w.id, concretizer.getStatus(models), models,
+                    concretizer.getTime(), SOURCE_PROBES,
+                    this->coverage.slotHits(slot), w.novel, nullptr, strategy);
+  return true;
+}
+
+void SymbolicExplorator::findNewInputs(Worker &w) {
+  triton::uint64 pathaddrs = PATH_HASH_INIT;
+  const auto &pcs = w.ctx->getPathConstraints();
+  auto ast = w.ctx->getAstContext();
 
   /* Building path predicate. Starting wite True. */
   auto predicate = ast->equal(ast->bvtrue(), ast->bvtrue());
 
-  for (const auto &pc : pcs) {
-    pathaddrs.push_back(pc.getSourceAddress());
+  /* Either the predicates a branch depends on, one solver kept along the
+   * trace, or the path predicate sent with each query */
+  ConstraintSlicer slicer;
+  std::unique_ptr<IncrementalSolver> incremental;
+  if (!this->config.slicing && this->config.incremental &&
+      IncrementalSolver::isAvailable()) {
+    incremental = std::make_unique<IncrementalSolver>(this->config.timeout);
+  }
+
+  /* Branch queries of the path, asked once the known seeds are tried */
+  struct pending_s {
+    triton::usize pc;                      /* index of the path constraint */
+    triton::ast::SharedAbstractNode node;  /* the branch */
+    triton::ast::SharedAbstractNode query; /* the branch and its prefix */
+    triton::usize limit;
+    triton::uint32 slot;
+  };
+  std::vector<pending_s> pending;
+
+  for (triton::usize i = 0; i < pcs.size(); i++) {
+    const auto &pc = pcs[i];
+    pathaddrs = Donelist::extend(pathaddrs, pc.getSourceAddress());
     for (const auto &branch : pc.getBranchConstraints()) {
-      /* Do we already generated a model? */
-      std::list<triton::uint64> copy(pathaddrs);
-      copy.push_back(std::get<2>(branch));
-      if (this->donelist.find(copy) != this->donelist.end())
+      const auto slot =
+          EdgeTrace::slot(pc.getSourceAddress(), std::get<2>(branch));
+      /* Do we already generated a model? Insert the path encoding to the
+       * donelist in the same time. */
+      if (this->claim(w, Donelist::extend(pathaddrs, std::get<2>(branch))) ==
+          false)
         continue;
 
-      /* Insert the path encoding to the donelist */
-      this->donelist.insert(copy);
-
       /* MultipleBranches is true if the instruction is like jz, jb etc. */
+      pending_s q{i, nullptr, nullptr, 1, slot};
       if (pc.isMultipleBranches()) {
-        if (std::get<0>(branch) == false) {
-          auto c = ast->land(predicate, std::get<3>(branch));
-          auto model =
-              this->ini_ctx->getModel(c, &status, this->config.timeout);
-          // std::cout << c << std::endl;
-          if (status == triton::engines::solver::SAT) {
-            this->nbsat++;
-            this->worklist.push_front(model);
-          } else if (status == triton::engines::solver::TIMEOUT) {
-            this->nbtimeout++;
-          } else {
-            this->nbunsat++;
-          }
+        if (std::get<0>(branch) == true) {
+          continue;
         }
+        q.node = std::get<3>(branch);
       }
       /* MultipleBranches is false if the instruction is like jmp rax */
       else {
-        auto c = ast->land(predicate, ast->lnot(std::get<3>(branch)));
-        auto models = this->ini_ctx->getModels(c, this->config.jmp_model,
-                                               &status, this->config.timeout);
-        if (status == triton::engines::solver::SAT) {
-          for (const auto &model : models) {
-            this->nbsat++;
-            this->worklist.push_front(model);
+        q.node = ast->lnot(std::get<3>(branch));
+        q.limit = this->config.jmp_model;
+      }
+
+      if (this->config.slicing) {
+        triton::usize kept = 0;
+        q.query = slicer.slice(ast, q.node, kept);
+        this->slicedKept += kept;
+        this->slicedTotal += slicer.size();
+      } else {
+        q.query = ast->land(predicate, q.node);
+      }
+      pending.push_back(std::move(q));
+    }
+    if (this->config.slicing) {
+      slicer.add(pc.getTakenPredicate());
+    } else {
+      predicate = ast->land(predicate, pc.getTakenPredicate());
+    }
+  }
+
+  /* A known seed that satisfies a branch query answers it. Evaluating the
+   * queries on a seed only costs its injection in the context. */
+  std::vector<bool> answered(pending.size(), false);
+  std::vector<Seed> known;
+  if (this->candidates.enabled()) {
+    this->candidates.sample(known);
+  }
+  if (!known.empty()) {
+    for (const auto &q : pending) {
+      this->reuseTried += q.limit == 1;
+    }
+    for (const auto &seed : known) {
+      this->layout.inject(w.ctx, w.vars, seed);
+      for (triton::usize i = 0; i < pending.size(); i++) {
+        const auto &q = pending[i];
+        if (answered[i] || q.limit != 1 || q.query->evaluate() == 0) {
+          continue;
+        }
+        answered[i] = true;
+        this->reuseHits++;
+
+        /* A whole path predicate: the seed was executed along this path
+         * and took the branch, nothing new. A slice: its variables on top
+         * of our seed give the flipped seed. */
+        if (this->config.slicing) {
+          Models models(1);
+          for (const auto &n :
+               triton::ast::search(q.query, triton::ast::VARIABLE_NODE)) {
+            const auto &var = static_cast<triton::ast::VariableNode *>(n.get())
+                                  ->getSymbolicVariable();
+            models[0][var->getId()] = triton::engines::solver::SolverModel(
+                var, w.ctx->getConcreteVariableValue(var));
           }
-        } else if (status == triton::engines::solver::TIMEOUT) {
-          this->nbtimeout++;
-        } else {
-          this->nbunsat++;
+          this->mergeModels(w.id, triton::engines::solver::SAT, models, 0,
+                            SOURCE_REUSE, this->coverage.slotHits(q.slot),
+                            w.novel, &w.task->entry.seed);
         }
       }
     }
-    predicate = ast->land(predicate, pc.getTakenPredicate());
+    this->layout.inject(w.ctx, w.vars, w.task->entry.seed);
   }
-}
 
-std::vector<triton::uint8> SymbolicExplorator::seed2vector(const Seed &seed) {
-  std::vector<triton::uint8> ret;
+  /* Conjuncts asserted in the incremental solver, for the query cache */
+  QueryPrefix prefix;
+  auto asserts = ast->equal(ast->bvtrue(), ast->bvtrue());
+  triton::usize asserted = 0;
 
-  const auto vars = this->ini_ctx->getSymbolicVariables();
-  ret.resize(vars.size());
-  for (triton::usize i = 0; i < vars.size(); i++) {
-    if (seed.find(i) == seed.end())
-      ret[i] = 0x00;
-    else
-      ret[i] = triton::utils::cast<triton::uint8>(seed.at(i).getValue());
-  }
+  for (triton::usize i = 0; i < pending.size(); i++) {
+    if (answered[i]) {
+      continue;
+    }
+    const auto &q = pending[i];
+    if (!incremental) {
+      this->solve(w, q.query, q.limit, q.slot, this->config.slicing);
+      continue;
+    }
 
-  return ret;
-}
+    /* The solver holds the taken predicates before the branch */
+    for (; asserted < q.pc; asserted++) {
+      incremental->assertion(pcs[asserted].getTakenPredicate());
+      if (this->queries.enabled()) {
+        prefix.add(pcs[asserted].getTakenPredicate());
+        asserts = ast->land(asserts, pcs[asserted].getTakenPredicate());
+      }
+    }
 
-void SymbolicExplorator::injectSeed(const Seed &seed) {
-  for (const auto &item : seed) {
-    auto var = this->ini_ctx->getSymbolicVariable(item.first);
-    this->ini_ctx->setConcreteVariableValue(var, item.second.getValue());
+    Models models;
+    triton::engines::solver::status_e status;
+    QueryKey key;
+    if (this->queries.enabled()) {
+      key = prefix.key(q.node);
+      auto check = [&](const Models &m) {
+        return this->satisfies(w, ast->land(asserts, q.node), m);
+      };
+      if (this->queries.lookup(key, q.limit, w.vars, status, models, check)) {
+        this->mergeModels(w.id, status, models, 0, SOURCE_CACHE,
+                          this->coverage.slotHits(q.slot), w.novel);
+        continue;
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    status = incremental->check(q.node, q.limit, models);
+    const triton::uint64 time =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+    if (this->queries.enabled()) {
+      this->queries.insert(key, q.limit, status, models);
+    }
+    this->mergeModels(w.id, status, models, time, SOURCE_SOLVER,
+                      this->coverage.slotHits(q.slot), w.novel);
   }
 }
 
-std::stringstream SymbolicExplorator::seedRepr(void) {
+void SymbolicExplorator::injectSeed(Worker &w, const Seed &seed) {
+  this->layout.inject(w.ctx, w.vars, seed);
+}
+
+std::stringstream SymbolicExplorator::seedRepr(Worker &w) {
   std::stringstream ss;
-  auto vars = this->ini_ctx->getSymbolicVariables();
+  auto vars = w.ctx->getSymbolicVariables();
   for (triton::usize i = 0; i < vars.size(); i++) {
     ss << std::hex << std::setw(2) << std::setfill('0')
-       << this->ini_ctx->getConcreteVariableValue(vars[i]) << " ";
+       << w.ctx->getConcreteVariableValue(vars[i]) << " ";
   }
   return ss;
 }
 
 void SymbolicExplorator::printStat(void) {
-  std::cout << "[TT] exec: " << std::dec << this->nbexec
-            << ",  icov: " << this->coverage.size() << ",  sat: " << this->nbsat
-            << ",  unsat: " << this->nbunsat
-            << ",  timeout: " << this->nbtimeout
-            << ",  worklist: " << this->worklist.size() << std::endl;
+  std::lock_guard<std::mutex> guard(this->statLock);
+  std::cout << "[TT] exec: " << std::dec << this->nbexec.load()
+            << ",  icov: " << this->coverage.instructions()
+            << ",  ecov: " << this->coverage.edges()
+            << ",  sat: " << this->nbsat.load()
+            << ",  unsat: " << this->nbunsat.load()
+            << ",  timeout: " << this->nbtimeout.load()
+            << ",  worklist: " << this->worklist.size();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - this->startTime;
+  if (elapsed.count() > 0) {
+    std::cout << ",  exec/s: "
+              << static_cast<triton::usize>(this->nbexec / elapsed.count());
+  }
+  if (this->nbexec) {
+    std::cout << ",  restore: "
+              << this->metrics.average(PHASE_RESTORE) / 1000 << "us";
+  }
+  if (this->config.decode_cache) {
+    triton::usize hits = 0, lookups = 0;
+    for (const auto &w : this->workers) {
+      hits += w.icache.hits();
+      lookups += w.icache.hits() + w.icache.misses();
+    }
+    if (lookups) {
+      std::cout << ",  icache: " << hits * 100 / lookups << "%";
+    }
+  }
+  if (this->slicedTotal) {
+    std::cout << ",  slice: " << this->slicedKept * 100 / this->slicedTotal
+              << "%";
+  }
+  if (this->config.ea_strategy != EA_STRATEGY_NONE) {
+    std::cout << ",  ea(" << EaConcretizer::name(this->config.ea_strategy)
+              << "): " << this->metrics.seeds(this->config.ea_strategy);
+  }
+  if (this->reuseTried) {
+    std::cout << ",  reuse: " << this->reuseHits * 100 / this->reuseTried
+              << "%";
+  }
+  const auto answered = this->queries.hits() + this->queries.subsumed();
+  if (answered + this->queries.misses()) {
+    std::cout << ",  qcache: "
+              << answered * 100 / (answered + this->queries.misses()) << "%";
+  }
+  if (this->queries.evicted()) {
+    std::cout << ",  qevict: " << this->queries.evicted();
+  }
+  if (this->solver.isRunning()) {
+    std::cout << ",  squeue: " << this->solver.queueDepth()
+              << ",  sflight: " << this->solver.inFlight();
+  }
+  std::cout << std::endl;
+}
+
+void SymbolicExplorator::report(void) {
+  MetricsSample s;
+  s.execs = this->nbexec;
+  s.sat = this->nbsat;
+  s.unsat = this->nbunsat;
+  s.timeout = this->nbtimeout;
+  s.worklist = this->worklist.size();
+  s.icov = this->coverage.instructions();
+  s.ecov = this->coverage.edges();
+  s.squeue = this->solver.isRunning() ? this->solver.queueDepth() : 0;
+  this->metrics.write(s);
+
+  if (this->config.stats) {
+    this->printStat();
+  }
+}
+
+void SymbolicExplorator::hookInstruction(triton::uint64 addr, instCallback fn,
+                                         hook_e when,
+                                         const std::string &name) {
+  this->hooks.add(addr, fn, when, name);
+}
+
+bool SymbolicExplorator::satisfies(Worker &w,
+                                   const triton::ast::SharedAbstractNode &node,
+                                   const Models &models) {
+  /* Evaluated as the known seeds are: the model goes into the variables,
+   * which then get their value back */
+  std::vector<std::pair<triton::engines::symbolic::SharedSymbolicVariable,
+                        triton::uint512>>
+      saved;
+  bool ok = true;
+  for (const auto &model : models) {
+    for (const auto &item : model) {
+      const auto &var = item.second.getVariable();
+      saved.emplace_back(var, w.ctx->getConcreteVariableValue(var));
+      w.ctx->setConcreteVariableValue(var, item.second.getValue());
+    }
+    ok = node->evaluate() != 0;
+    for (auto it = saved.rbegin(); it != saved.rend(); it++) {
+      w.ctx->setConcreteVariableValue(it->first, it->second);
+    }
+    saved.clear();
+    if (!ok) {
+      break;
+    }
+  }
+  return ok;
+}
+
+void SymbolicExplorator::reportSolution(triton::usize exec) {
+  if (this->solved.exchange(true)) {
+    return;
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - this->startTime;
+  this->solutionExec = exec + 1;
+  this->solutionTime =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  std::lock_guard<std::mutex> guard(this->statLock);
+  std::cout << "[TT] " << Scheduler::name(this->config.schedule)
+            << ": first solution after " << elapsed.count() << "s, "
+            << std::dec << exec + 1 << " execs" << std::endl;
+}
+
+bool SymbolicExplorator::claim(Worker &w, triton::uint64 key) {
+  /* A checkpoint sees both the key and its owner or none of them */
+  std::shared_lock<std::shared_mutex> hold(this->gate);
+  if (this->donelist.insert(key) == false) {
+    return false;
+  }
+  w.task->keys.push_back(key);
+  return true;
 }
 
-void SymbolicExplorator::hookInstruction(triton::uint64 addr, instCallback fn) {
-  this->instHooks.insert(std::pair<triton::uint64, instCallback>(addr, fn));
+void SymbolicExplorator::openTask(Worker &w, SeedEntry &&entry) {
+  w.task = std::make_shared<Task>();
+  w.task->entry = std::move(entry);
+  w.task->refs = 1;
+  std::lock_guard<std::mutex> guard(this->tasksLock);
+  this->tasks.insert(w.task.get());
+  if (this->ckptOpen) {
+    this->ckptOpened.push_back(w.task->entry);
+  }
+}
+
+void SymbolicExplorator::closeTask(const std::shared_ptr<Task> &task) {
+  if (--task->refs == 0) {
+    std::lock_guard<std::mutex> guard(this->tasksLock);
+    this->tasks.erase(task.get());
+  }
+}
+
+void SymbolicExplorator::checkpointIfDue(void) {
+  if (this->config.checkpoint_interval == 0) {
+    return;
+  }
+
+  /* One worker takes it, the others go on */
+  const triton::sint64 now =
+      std::chrono::duration_cast<std::chrono::seconds>(
+          std::chrono::steady_clock::now() - this->startTime)
+          .count();
+  auto last = this->lastCheckpoint.load();
+  if (now - last < static_cast<triton::sint64>(
+                       this->config.checkpoint_interval) ||
+      this->lastCheckpoint.compare_exchange_strong(last, now) == false) {
+    return;
+  }
+  this->checkpoint();
+}
+
+void SymbolicExplorator::checkpoint(void) {
+  Checkpoint ckpt;
+  std::vector<triton::uint64> open;
+  Donelist::Marks marks;
+
+  /* Freeze the claims and the seed publications just long enough to cut the
+   * donelist journals and copy the seeds being processed. The queries of
+   * these seeds are dropped from the donelist, their seeds are asked again
+   * on resume. */
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::unique_lock<std::shared_mutex> freeze(this->gate);
+    this->donelist.marks(marks);
+    std::lock_guard<std::mutex> guard(this->tasksLock);
+    for (const auto task : this->tasks) {
+      ckpt.seeds.push_back(task->entry);
+      open.insert(open.end(), task->keys.begin(), task->keys.end());
+    }
+    this->ckptOpen = true;
+    ckpt.nbexec = this->nbexec;
+    ckpt.nbsat = this->nbsat;
+    ckpt.nbunsat = this->nbunsat;
+    ckpt.nbtimeout = this->nbtimeout;
+  }
+  auto pause = std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+
+  /* The worklist is copied lane by lane while the workers run. A seed popped
+   * meanwhile is recorded when opened, at worst it is saved twice. */
+  this->worklist.copy(ckpt.seeds);
+  start = std::chrono::steady_clock::now();
+  {
+    std::unique_lock<std::shared_mutex> freeze(this->gate);
+    std::lock_guard<std::mutex> guard(this->tasksLock);
+    this->ckptOpen = false;
+    for (auto &entry : this->ckptOpened) {
+      ckpt.seeds.push_back(std::move(entry));
+    }
+    this->ckptOpened.clear();
+  }
+  pause += std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+               .count();
+
+  /* Only the keys recorded since the previous checkpoint are copied */
+  this->donelist.journal(this->ckptMarks, marks, this->ckptKeys);
+  this->ckptMarks = marks;
+  std::sort(open.begin(), open.end());
+  ckpt.donelist.reserve(this->ckptKeys.size());
+  for (const auto key : this->ckptKeys) {
+    if (!std::binary_search(open.begin(), open.end(), key)) {
+      ckpt.donelist.push_back(key);
+    }
+  }
+
+  ckpt.seedSize = this->layout.size();
+  this->coverage.save(ckpt.virgin, ckpt.hits, ckpt.pcs);
+
+  /* The stores must hold what the checkpoint counts */
+  this->corpus.flush();
+  this->crashes.flush();
+  this->outputs.flush();
+  ckpt.write(this->config.workspace + "/" + CHECKPOINT_FILE);
+
+  /* A killed run resumes with a warm cache */
+  if (this->config.query_cache_persist && this->queries.enabled()) {
+    this->queries.save(this->config.workspace + "/" + QUERY_CACHE_FILE,
+                       this->queryStamp);
+  }
+
+  if (this->config.stats) {
+    std::lock_guard<std::mutex> guard(this->statLock);
+    std::cout << "[TT] checkpoint: " << std::dec << ckpt.seeds.size()
+              << " seeds, " << ckpt.donelist.size() << " queries, pause "
+              << pause << "us" << std::endl;
+  }
+}
+
+bool SymbolicExplorator::resume(void) {
+  Checkpoint ckpt;
+  const auto path = this->config.workspace + "/" + CHECKPOINT_FILE;
+  if (ckpt.read(path) == false) {
+    return false;
+  }
+  if (ckpt.seedSize != this->layout.size()) {
+    throw triton::exceptions::Engines(
+        "SymbolicExplorator::resume(): " + path +
+        " has been written for another target.");
+  }
+
+  this->nbexec = ckpt.nbexec;
+  this->nbsat = ckpt.nbsat;
+  this->nbunsat = ckpt.nbunsat;
+  this->nbtimeout = ckpt.nbtimeout;
+  for (const auto key : ckpt.donelist) {
+    this->donelist.insert(key);
+  }
+  this->coverage.load(ckpt.virgin, ckpt.hits, ckpt.pcs);
+
+  /* Spread the seeds over the lanes */
+  for (triton::usize i = 0; i < ckpt.seeds.size(); i++) {
+    this->worklist.push(i, std::move(ckpt.seeds[i]));
+  }
+
+  if (this->config.stats) {
+    std::cout << "[TT] resumed: " << std::dec << ckpt.seeds.size()
+              << " seeds, " << ckpt.donelist.size() << " queries, "
+              << ckpt.nbexec << " execs" << std::endl;
+  }
+  return true;
+}
+
+void SymbolicExplorator::work(Worker &w) {
+  SymbolicExplorator::current = &w;
+  SeedEntry entry;
+  std::shared_lock<std::shared_mutex> hold(this->gate, std::defer_lock);
+
+  /* Pickup a seed, from our lane first */
+  while (this->worklist.pop(w.id, entry, hold)) {
+    /* Publish the seed before a checkpoint can miss it */
+    this->openTask(w, std::move(entry));
+    hold.unlock();
+    const Seed &seed = w.task->entry.seed;
+
+    /* Rate limited, one worker reports for all of them */
+    if (this->metrics.due()) {
+      this->report();
+    }
+
+    /* Inject seed into the context */
+    this->injectSeed(w, seed);
+
+    /* Execute the target */
+    auto start = std::chrono::steady_clock::now();
+    this->run(w, seed);
+    this->metrics.add(PHASE_RUN, start);
+
+    /* Generate new seeds */
+    start = std::chrono::steady_clock::now();
+    this->findNewInputs(w);
+    this->metrics.add(PHASE_FIND_INPUTS, start);
+    this->candidates.add(seed, w.novel);
+
+    /* Restore initial context */
+    this->restoreContext(w);
+    w.icache.endRun();
+
+    /* The seed is processed, up to its pending solver jobs */
+    this->closeTask(w.task);
+    w.task.reset();
+    this->worklist.done();
+
+    this->checkpointIfDue();
+  }
+  SymbolicExplorator::current = nullptr;
 }
 
 void SymbolicExplorator::explore(void) {
@@ -398,41 +1143,176 @@ void SymbolicExplorator::explore(void) {
         "SymbolicExplorator::explore(): The initial context cannot be null.");
   }
 
+  if (this->config.workers == 0) {
+    throw triton::exceptions::Engines(
+        "SymbolicExplorator::explore(): The number of workers cannot be null.");
+  }
+
+  /* A dirty restore rewinds the bytes written, not the stores recorded in
+   * the memory array, the next run would load through them */
+  if (this->config.ea_strategy == EA_STRATEGY_ARRAY &&
+      this->config.dirty_restore) {
+    throw triton::exceptions::Engines(
+        "SymbolicExplorator::explore(): The array strategy needs full "
+        "restores, unset dirty_restore.");
+  }
+
+  this->setup();
+
+  /* Run the workers, the calling thread is the first one */
+  std::vector<std::exception_ptr> errors(this->workers.size());
+  std::vector<std::thread> threads;
+  auto body = [this, &errors](triton::usize i) {
+    try {
+      this->work(this->workers[i]);
+    } catch (...) {
+      errors[i] = std::current_exception();
+      this->worklist.abort();
+    }
+  };
+  for (triton::usize i = 1; i < this->workers.size(); i++) {
+    threads.emplace_back(body, i);
+  }
+  body(0);
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  this->teardown();
+
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void SymbolicExplorator::setup(void) {
+  /* Addresses left symbolic read and write the memory as an SMT array */
+  if (this->config.ea_strategy == EA_STRATEGY_ARRAY) {
+    this->ini_ctx->setMode(triton::modes::MEMORY_ARRAY, true);
+  }
+  this->eaArrays.clear();
+
   /* Alocate and init a backup context */
   this->bck_ctx = new triton::Context(this->ini_ctx->getArchitecture());
   this->snapshotContext(this->bck_ctx, this->ini_ctx);
 
-  this->initWorklist();
-  while (this->worklist.size()) {
-    /* Pickup a seed */
-    auto seed = *(this->worklist.begin());
-    if (this->config.stats) {
-      this->printStat();
-    }
+  /* Seeds are laid out after the variables of the initial context */
+  this->layout.init(this->ini_ctx);
 
-    /* Remove the seed from the worklist */
-    this->worklist.erase(this->worklist.begin());
+  /* Saved answers only hold for the same image and seed layout. The memory
+   * map has no order, so its bytes are mixed in commutatively. */
+  this->queryStamp = this->layout.fingerprint();
+  const auto &image = this->ini_ctx->getCpuInstance()->getConcreteMemory();
+  for (const auto &item : image) {
+    this->queryStamp +=
+        ((item.first << 8) ^ item.second ^ 0x9e3779b97f4a7c15) *
+        0xbf58476d1ce4e5b9;
+  }
 
-    /* Inject seed into the context */
-    this->injectSeed(seed);
+  /* Setup workers. The first one runs on the initial context, the others on
+   * their own clone of it. */
+  this->workers = std::vector<Worker>(this->config.workers);
+  for (triton::usize i = 0; i < this->workers.size(); i++) {
+    auto &w = this->workers[i];
+    w.id = i;
+    if (i == 0) {
+      w.ctx = this->ini_ctx;
+      w.bck = this->bck_ctx;
+    } else {
+      w.ctx = this->cloneContext(this->ini_ctx);
+      w.bck = new triton::Context(this->ini_ctx->getArchitecture());
+      this->snapshotContext(w.bck, w.ctx);
+    }
+    for (triton::usize id = 0; id < this->layout.variables(); id++) {
+      w.vars.push_back(w.ctx->getSymbolicVariable(id));
+    }
 
-    /* Execute the target */
-    this->run(seed);
+    /* Allocations of the executions start from here */
+    w.heap.attach(w.ctx, this->config.heap_redzones);
+    w.heap.mark();
 
-    /* Generate new seeds */
-    this->findNewInputs();
+    /* From now on, record what the executions write */
+    if (this->config.dirty_restore) {
+      w.dirty.attach(w.ctx);
+    }
+    if (this->config.decode_cache) {
+      w.icache.attach(w.ctx);
+    }
+  }
 
-    /* Restore initial context */
-    this->snapshotContext(this->ini_ctx, this->bck_ctx);
+  this->hooks.build();
+  if (this->config.trace) {
+    this->tracer.open(this->config.workspace + "/" + TRACE_FILE,
+                      this->workers.size(), this->hooks.names());
+  }
+  for (auto &w : this->workers) {
+    w.trace = this->tracer.ring(w.id);
+  }
+  this->worklist.resize(this->workers.size(), this->config.schedule,
+                        this->config.restart_interval, this->config.rng_seed);
+  this->startTime = std::chrono::steady_clock::now();
+  this->metrics.open(this->config.workspace + "/stats",
+                     this->config.stats_interval);
+  this->queries.reset(this->config.query_cache);
+  this->candidates.reset(this->config.reuse_candidates);
+  if (this->config.query_cache_persist && this->queries.enabled()) {
+    this->queries.load(this->config.workspace + "/" + QUERY_CACHE_FILE,
+                       this->queryStamp);
+  }
+  this->lastCheckpoint = 0;
+  this->ckptKeys.clear();
+  this->ckptMarks.fill(0);
+  this->solved = false;
+  this->solutionExec = 0;
+  this->solutionTime = 0;
+  this->initWorklist();
+  this->solver.start(this->config.solver_threads);
+}
+
+void SymbolicExplorator::teardown(void) {
+  /* Pending jobs keep the worklist alive, the pool is idle at this point */
+  this->solver.stop();
+  this->tracer.close();
+  if (this->config.checkpoint_interval) {
+    this->checkpoint();
+  } else if (this->config.query_cache_persist && this->queries.enabled()) {
+    this->queries.save(this->config.workspace + "/" + QUERY_CACHE_FILE,
+                       this->queryStamp);
   }
+  this->corpus.close();
+  this->crashes.close();
+  this->outputs.close();
 
   /* Last stats */
+  this->report();
+  this->metrics.close();
   if (this->config.stats) {
-    this->printStat();
+    if (this->config.target && this->solved == false) {
+      std::cout << "[TT] " << Scheduler::name(this->config.schedule)
+                << ": no solution" << std::endl;
+    }
+    this->hooks.print(std::cout);
+    if (this->tracer.dropped()) {
+      std::cout << "[TT] trace: " << std::dec << this->tracer.dropped()
+                << " events dropped" << std::endl;
+    }
   }
 
-  /* Delete the allocated backup context */
+  /* Delete the allocated contexts */
+  for (auto &w : this->workers) {
+    w.dirty.detach();
+    w.icache.detach();
+    w.heap.detach();
+    if (w.ctx != this->ini_ctx) {
+      delete w.ctx;
+      delete w.bck;
+    }
+  }
+  this->workers.clear();
   delete this->bck_ctx;
+  this->bck_ctx = nullptr;
 }
 
 }; // namespace exploration
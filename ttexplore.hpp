@@ -8,10 +8,15 @@
 #define TRITON_TTEXPLORE_H
 
 
-#include <list>
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <triton/comparableFunctor.hpp>
@@ -21,6 +26,25 @@
 #include <triton/solverModel.hpp>
 #include <triton/tritonTypes.hpp>
 
+#include "checkpoint.hpp"
+#include "concretize.hpp"
+#include "corpusstore.hpp"
+#include "coverage.hpp"
+#include "decodecache.hpp"
+#include "dirtystate.hpp"
+#include "donelist.hpp"
+#include "heap.hpp"
+#include "hooktable.hpp"
+#include "incsolver.hpp"
+#include "metrics.hpp"
+#include "output.hpp"
+#include "querycache.hpp"
+#include "seedlayout.hpp"
+#include "seedpool.hpp"
+#include "slicer.hpp"
+#include "solverpool.hpp"
+#include "trace.hpp"
+#include "worklist.hpp"
 
 
 //! The Triton namespace
@@ -30,23 +54,6 @@ namespace triton {
  *  @{
  */
 
-  //! The Callbacks namespace
-  namespace callbacks {
-  /*!
-   *  \ingroup triton
-   *  \addtogroup callbacks
-   *  @{
-   */
-
-    //! State of callback
-    enum cb_state_e {
-      CONTINUE,
-      BREAK,
-      PLT_CONTINUE,
-    };
-
-  };
-
   //! The Engines namespace
   namespace engines {
   /*!
@@ -63,75 +70,237 @@ namespace triton {
      *  @{
      */
 
-      //! Shortcut for a seed.
-      using Seed = std::unordered_map<triton::usize, triton::engines::solver::SolverModel>;
-
       //! Config of the exploration.
       struct config_s {
         bool            stats;
+        triton::usize   stats_interval; /* seconds between two stats reports */
         std::string     workspace = "workspace";
         triton::uint64  end_point;
-        triton::usize   ea_model;
+        triton::usize   ea_model; /* models of an address with EA_STRATEGY_ALL */
+        ea_strategy_e   ea_strategy; /* how a new symbolic address gives seeds */
+        triton::usize   ea_samples; /* models with EA_STRATEGY_SAMPLE, pages with EA_STRATEGY_PAGES */
+        triton::uint64  ea_array_range; /* widest range left symbolic with EA_STRATEGY_ARRAY, needs dirty_restore off */
+        triton::usize   ea_probes; /* max queries for each bound of a range, 0: no limit */
         triton::usize   jmp_model;
         triton::usize   limit_inst;
         triton::usize   timeout; /* seconds */
+        triton::usize   workers; /* exploration threads */
+        triton::usize   solver_threads; /* 0: solve in the exploration threads */
+        bool            dirty_restore; /* false: full snapshot after each run */
+        bool            decode_cache; /* reuse the disassembly of executed instructions */
+        /* Branch queries go, in this order of precedence: sliced to the
+         * solver pool if slicing, to one synchronous solver per trace if
+         * incremental, else whole to the solver pool */
+        bool            slicing; /* send only the dependent predicates, the default */
+        bool            incremental; /* one solver per trace, ignored with slicing */
+        schedule_e      schedule; /* seed scheduling policy */
+        triton::usize   restart_interval; /* picks between random restarts */
+        triton::uint64  rng_seed; /* seed of the random policies */
+        triton::uint64  target; /* reaching this address is a solution */
+        triton::usize   checkpoint_interval; /* seconds, 0: no checkpoint */
+        bool            resume; /* continue from the workspace checkpoint */
+        bool            heap_redzones; /* guard the guest heap chunks */
+        bool            quiet; /* do not print the guest output */
+        bool            trace; /* record the executions in workspace/trace.bin */
+        triton::usize   query_cache; /* max cached solver answers, 0: no cache */
+        bool            query_cache_persist; /* keep the answers in workspace/queries.bin */
+        triton::usize   reuse_candidates; /* executed seeds tried before the solver, 0: none */
       };
 
-      //! Instruction callback signature
-      using instCallback = triton::ComparableFunctor<triton::callbacks::cb_state_e(triton::Context*)>;
+      //! A seed being processed, alive until its last solver query is answered.
+      struct Task {
+        //! The seed.
+        SeedEntry entry;
+
+        //! Donelist keys claimed while running the seed.
+        std::vector<triton::uint64> keys;
+
+        //! The worker and the pending solver jobs of the seed.
+        std::atomic<triton::usize> refs;
+      };
+
+      //! State owned by one exploration thread.
+      struct Worker {
+        //! Worker id, also its lane in the worklist.
+        triton::usize id;
+
+        //! Emulation context of the worker.
+        triton::Context* ctx;
+
+        //! Backup context restored after each execution.
+        triton::Context* bck;
+
+        //! Symbolic variables of ctx, by id.
+        std::vector<triton::engines::symbolic::SharedSymbolicVariable> vars;
+
+        //! Seed being processed.
+        std::shared_ptr<Task> task;
+
+        //! Edges of the current execution, merged into the shared map at the end of the run.
+        EdgeTrace edges;
+
+        //! True if the last execution hit new edges.
+        bool novel;
+
+        //! Write set of the current execution.
+        DirtyState dirty;
+
+        //! Decoded instructions, kept across executions.
+        DecodeCache icache;
+
+        //! Guest heap, rewound after each execution.
+        GuestHeap heap;
+
+        //! Guest output of the current execution.
+        OutputCapture output;
+
+        //! Trace ring of the worker, nullptr if not tracing.
+        TraceRing* trace;
+
+        //! Path encoding of the first pathLen path constraints of the execution.
+        triton::uint64 pathHash;
+
+        //! Number of path constraints folded into pathHash.
+        triton::usize pathLen;
+
+        //! Time (ns) spent on symbolic effective addresses during the execution.
+        triton::uint64 eaTime;
+
+        //! Symbolic effective addresses handled during the execution.
+        triton::uint64 eaCalls;
+      };
 
       /*! \class SymbolicExplorator
           \brief The symbolic explorator class. */
       class SymbolicExplorator {
+        //! Times the phases of an execution one by one, see bench.cpp.
+        friend class ExploratorBench;
+
         private:
           //! Execute one trace.
-          void run(const Seed& seed);
+          void run(Worker& w, const Seed& seed);
 
           //! Init the worklist.
           void initWorklist(void);
 
+          //! Exploration loop of a worker.
+          void work(Worker& w);
+
+          //! Create the workers and the initial seed, start the solver pool.
+          void setup(void);
+
+          //! Stop the solver pool, write the last stats and delete the workers.
+          void teardown(void);
+
+          //! Copy the concrete CPU state from src to dst.
+          void copyConcreteState(triton::Context* dst, triton::Context* src);
+
           //! Snaptshot context from src to dst.
           void snapshotContext(triton::Context* dst, triton::Context* src);
 
+          //! Restore the worker context to its backup after an execution.
+          void restoreContext(Worker& w);
+
+          //! Create a new context with the same modes, concrete state and symbolic variables as src.
+          triton::Context* cloneContext(triton::Context* src);
+
           //! Find new inputs and update the path tree.
-          void findNewInputs(void);
+          void findNewInputs(Worker& w);
 
           //! Inject a seed into the state.
-          void injectSeed(const Seed& seed);
+          void injectSeed(Worker& w, const Seed& seed);
 
           //! Pretty print a seed.
-          std::stringstream seedRepr(void);
+          std::stringstream seedRepr(Worker& w);
 
-          //! Print stats at each execution
+          //! Print stats
           void printStat(void);
 
+          //! Print the stats and write the metrics files.
+          void report(void);
+
+          //! Ask the solver for up to limit models of node, new seeds aim at the edge slot and go to the worker lane. With fromSeed, unconstrained variables keep their value in the worker seed. An address query accounts its answer to strategy.
+          void solve(Worker& w, const triton::ast::SharedAbstractNode& node, triton::usize limit, triton::uint32 slot, bool fromSeed = false, ea_strategy_e strategy = EA_STRATEGY_COUNT);
+
+          //! Push the models of an answer into the given lane, on top of base if not null. Only a SOURCE_SOLVER answer, which took time microseconds, counts in the sat/unsat/timeout stats and latencies. Address answers are also accounted to their strategy.
+          void mergeModels(triton::usize lane, triton::engines::solver::status_e status, const Models& models, triton::uint64 time, answer_source_e source, triton::uint32 hits, bool novel, const Seed* base = nullptr, ea_strategy_e strategy = EA_STRATEGY_COUNT);
+
+          //! True if each model satisfies node on the worker context, whose variables are left as they were.
+          bool satisfies(Worker& w, const triton::ast::SharedAbstractNode& node, const Models& models);
+
+          //! Record that an execution reached config.target.
+          void reportSolution(triton::usize exec);
+
           //! Symbolize LOAD and STORE accesses.
-          void symbolizeEffectiveAddress(const triton::arch::Instruction& inst);
+          void symbolizeEffectiveAddress(Worker& w, const triton::arch::Instruction& inst);
+
+          //! Ask for the seeds of an address new on this path, false if the address stays symbolic.
+          bool concretizeEffectiveAddress(Worker& w, const triton::arch::Instruction& inst, const triton::ast::SharedAbstractNode& ea);
+
+          //! Build the path encoding, incrementally along the execution
+          triton::uint64 buildPathHash(Worker& w);
+
+          //! Record a query in the donelist on behalf of the worker seed. Returns false if it was already there.
+          bool claim(Worker& w, triton::uint64 key);
 
-          //! Build the path encoding
-          std::list<triton::uint64> buildPathAddrs(void);
+          //! Make a popped seed the task of the worker, the gate is held.
+          void openTask(Worker& w, SeedEntry&& entry);
 
-          //! Convert a seed to a vector.
-          std::vector<triton::uint8> seed2vector(const Seed& seed);
+          //! Drop a reference to a task, forget it with the last one.
+          void closeTask(const std::shared_ptr<Task>& task);
+
+          //! Checkpoint if config.checkpoint_interval elapsed since the last one.
+          void checkpointIfDue(void);
+
+          //! Write a checkpoint of the exploration in the workspace.
+          void checkpoint(void);
+
+          //! Reload the workspace checkpoint. Returns false if there is none.
+          bool resume(void);
 
-          //! Write the seed into the given directory
-          void writeSeedOnDisk(const std::string& dir, const Seed& seed);
 
           //! Execute a ret instruction according to the architecture
-          void asmret(void);
+          void asmret(Worker& w);
 
         protected:
           //! Number of executions
-          triton::usize nbexec;
+          std::atomic<triton::usize> nbexec;
 
           //! Number of sat
-          triton::usize nbsat;
+          std::atomic<triton::usize> nbsat;
 
           //! Number of unsat
-          triton::usize nbunsat;
+          std::atomic<triton::usize> nbunsat;
 
           //! Number of timeout
-          triton::usize nbtimeout;
+          std::atomic<triton::usize> nbtimeout;
+
+          //! Rates, phase timings and solver latencies.
+          Metrics metrics;
+
+          //! Predicates sent with the sliced queries.
+          std::atomic<triton::usize> slicedKept;
+
+          //! Predicates of the paths of the sliced queries.
+          std::atomic<triton::usize> slicedTotal;
+
+          //! Branch queries evaluated on the known seeds.
+          std::atomic<triton::usize> reuseTried;
+
+          //! Branch queries a known seed satisfied.
+          std::atomic<triton::usize> reuseHits;
+
+          //! Start of the exploration.
+          std::chrono::steady_clock::time_point startTime;
+
+          //! True once an execution reached config.target.
+          std::atomic<bool> solved;
+
+          //! Execution that first reached config.target.
+          std::atomic<triton::usize> solutionExec;
+
+          //! Time (ns) from the start of the exploration to solutionExec.
+          std::atomic<triton::uint64> solutionTime;
 
           //! Initial context.
           triton::Context* ini_ctx;
@@ -139,17 +308,80 @@ namespace triton {
           //! Backup context.
           triton::Context* bck_ctx;
 
+          //! Workers, the first one runs on the initial context.
+          std::vector<Worker> workers;
+
           //! Worklist.
-          std::list<Seed> worklist;
+          WorkStealingQueue worklist;
+
+          //! Layout of the seeds.
+          SeedLayout layout;
+
+          //! Executed seeds, in workspace/corpus.
+          CorpusStore corpus;
+
+          //! Crashing seeds, in workspace/crashes.
+          CorpusStore crashes;
+
+          //! Distinct guest outputs, in workspace/outputs.
+          CorpusStore outputs;
+
+          //! Asynchronous solver threads.
+          SolverPool solver;
 
           //! Donelist
-          std::set<std::list<triton::uint64>> donelist;
+          Donelist donelist;
+
+          //! Solver answers by query.
+          QueryCache queries;
+
+          //! Fingerprint of the initial memory and the seed layout, stamps the saved answers.
+          triton::uint64 queryStamp;
+
+          //! Executed seeds tried on the branch queries before the solver.
+          SeedPool candidates;
+
+          //! Paths whose memory access stays symbolic, with EA_STRATEGY_ARRAY.
+          std::unordered_set<triton::uint64> eaArrays;
+
+          //! Protects eaArrays.
+          std::mutex eaLock;
+
+          //! Shared by the claims and the seed publications, exclusive while a checkpoint is taken.
+          std::shared_mutex gate;
+
+          //! Protects tasks.
+          std::mutex tasksLock;
 
-          //! The coverage map <inst addr: number of hits>
-          std::unordered_map<triton::uint64, triton::usize> coverage;
+          //! Seeds popped and not fully processed.
+          std::unordered_set<Task*> tasks;
+
+          //! True while a checkpoint copies the worklist, protected by tasksLock.
+          bool ckptOpen;
+
+          //! Seeds popped while ckptOpen.
+          std::vector<SeedEntry> ckptOpened;
+
+          //! Donelist keys copied by the previous checkpoints.
+          std::vector<triton::uint64> ckptKeys;
+
+          //! End of the donelist journals at the previous checkpoint.
+          Donelist::Marks ckptMarks;
+
+          //! Time of the last checkpoint (seconds since startTime).
+          std::atomic<triton::sint64> lastCheckpoint;
+
+          //! The edge coverage map
+          CoverageMap coverage;
+
+          //! Serializes the stats output.
+          std::mutex statLock;
 
           //! Hook instructions: <plt addr : cb>
-          std::map<triton::uint64, instCallback> instHooks;
+          HookTable hooks;
+
+          //! Binary trace of the executions.
+          Tracer tracer;
 
         public:
           struct config_s config;
@@ -173,7 +405,10 @@ namespace triton {
           TRITON_EXPORT void dumpCoverage(void);
 
           //! Add callback
-          TRITON_EXPORT void hookInstruction(triton::uint64 addr, instCallback fn);
+          TRITON_EXPORT void hookInstruction(triton::uint64 addr, instCallback fn, hook_e when = HOOK_PRE, const std::string& name = "");
+
+          //! Worker of the calling thread, the routines reach its heap and output through it. Null outside the exploration.
+          static thread_local Worker* current;
       };
 
     /*! @} End of exploration namespace */
@@ -1,189 +1,278 @@
+#include <algorithm>
+#include <atomic>
 #include <cstdarg>
-#include <regex>
+#include <cstring>
+#include <stdexcept>
 #include <triton/context.hpp>
 
+#include "heap.hpp"
 #include "utils.hpp"
 
 using namespace triton;
 
-extern triton::Context gctx;
-extern bool DEBUG;
-
-uint64 heap_base = 0xAFFFFFFF;
-
-std::map<int, std::vector<std::pair<std::string, arch::register_e>>> gpr = {
-    {arch::ARCH_X86_64,
-     {{"ip", arch::ID_REG_X86_RIP},
-      {"sp", arch::ID_REG_X86_RSP},
-      {"bp", arch::ID_REG_X86_RBP},
-      {"ret", arch::ID_REG_X86_RAX}}},
-    {arch::ARCH_X86,
-     {{"ip", arch::ID_REG_X86_EIP},
-      {"sp", arch::ID_REG_X86_ESP},
-      {"bp", arch::ID_REG_X86_EBP},
-      {"ret", arch::ID_REG_X86_EAX}}},
-    {arch::ARCH_AARCH64,
-     {{"ip", arch::ID_REG_AARCH64_PC},
-      {"sp", arch::ID_REG_AARCH64_SP},
-      {"bp", arch::ID_REG_AARCH64_X29},
-      {"ret", arch::ID_REG_AARCH64_X0}}},
-    {arch::ARCH_ARM32,
-     {{"ip", arch::ID_REG_ARM32_PC},
-      {"sp", arch::ID_REG_ARM32_SP},
-      {"bp", arch::ID_REG_ARM32_R11},
-      {"ret", arch::ID_REG_ARM32_R0}}}};
-
-std::map<int, std::vector<arch::register_e>> arg_regs = {
-    {arch::ARCH_X86_64,
-     {arch::ID_REG_X86_RDI, arch::ID_REG_X86_RSI, arch::ID_REG_X86_RDX,
-      arch::ID_REG_X86_R10, arch::ID_REG_X86_R8,
-      arch::ID_REG_X86_R9}}, // depend on calling convention R10 can be replaced
-                             // by RXC
-    {arch::ARCH_X86,
-     {arch::ID_REG_X86_EBX, arch::ID_REG_X86_ECX, arch::ID_REG_X86_EDX,
-      arch::ID_REG_X86_ESI, arch::ID_REG_X86_EDI, arch::ID_REG_X86_EBX}},
-    {arch::ARCH_AARCH64,
-     {arch::ID_REG_AARCH64_X0, arch::ID_REG_AARCH64_X1, arch::ID_REG_AARCH64_X2,
-      arch::ID_REG_AARCH64_X3, arch::ID_REG_AARCH64_X4,
-      arch::ID_REG_AARCH64_X5}},
-    {arch::ARCH_ARM32,
-     {arch::ID_REG_ARM32_R0, arch::ID_REG_ARM32_R1, arch::ID_REG_ARM32_R2,
-      arch::ID_REG_ARM32_R3, arch::ID_REG_ARM32_R4, arch::ID_REG_ARM32_R5}}};
-
-uint64 getStack(int number) {
-  auto sp_val = getGpr("sp");
-  arch::MemoryAccess var(sp_val + number * gctx.getGprSize(),
-                         gctx.getGprSize());
-  return static_cast<uint64>(gctx.getConcreteMemoryValue(var));
-}
-
-void setStack(int number, const uint64 value) {
-  auto sp_val = getGpr("sp");
-  arch::MemoryAccess var(sp_val + number * gctx.getGprSize(),
-                         gctx.getGprSize());
-  gctx.setConcreteMemoryValue(var, value);
-}
-
-arch::Register getArgReg(int number) {
-  auto regs = arg_regs[gctx.getArchitecture()];
-  arch::Register reg;
-  reg = gctx.getRegister(regs[number]);
-  return reg;
-}
-
-uint64 getArg(int number) {
-  auto regs = arg_regs[gctx.getArchitecture()];
-  uint64 ret;
-  arch::Register reg;
-  switch (number) {
-  case 0 ... 5:
-    reg = gctx.getRegister(regs[number]);
-    ret = static_cast<uint64>(gctx.getConcreteRegisterValue(reg));
-    break;
+// contexts without a guest heap, shared so allocations never overlap. Past
+// the guest heap, the stack grows down from below 0xA0000000 and its entry
+// frame sits right above.
+std::atomic<uint64> heap_base{engines::exploration::HEAP_BASE +
+                              engines::exploration::HEAP_SIZE};
+
+// Registers of each architecture, resolved at compile time
+template <arch::architecture_e A> struct ArchTraits;
+
+template <> struct ArchTraits<arch::ARCH_X86_64> {
+  static constexpr arch::register_e gpr[GPR_COUNT] = {
+      arch::ID_REG_X86_RIP, arch::ID_REG_X86_RSP, arch::ID_REG_X86_RBP,
+      arch::ID_REG_X86_RAX};
+  // System V function calls, a syscall would pass R10 instead of RCX
+  static constexpr arch::register_e args[ARG_REGS] = {
+      arch::ID_REG_X86_RDI, arch::ID_REG_X86_RSI, arch::ID_REG_X86_RDX,
+      arch::ID_REG_X86_RCX, arch::ID_REG_X86_R8,  arch::ID_REG_X86_R9};
+};
+
+template <> struct ArchTraits<arch::ARCH_X86> {
+  static constexpr arch::register_e gpr[GPR_COUNT] = {
+      arch::ID_REG_X86_EIP, arch::ID_REG_X86_ESP, arch::ID_REG_X86_EBP,
+      arch::ID_REG_X86_EAX};
+  static constexpr arch::register_e args[ARG_REGS] = {
+      arch::ID_REG_X86_EBX, arch::ID_REG_X86_ECX, arch::ID_REG_X86_EDX,
+      arch::ID_REG_X86_ESI, arch::ID_REG_X86_EDI, arch::ID_REG_X86_EBX};
+};
+
+template <> struct ArchTraits<arch::ARCH_AARCH64> {
+  static constexpr arch::register_e gpr[GPR_COUNT] = {
+      arch::ID_REG_AARCH64_PC, arch::ID_REG_AARCH64_SP,
+      arch::ID_REG_AARCH64_X29, arch::ID_REG_AARCH64_X0};
+  static constexpr arch::register_e args[ARG_REGS] = {
+      arch::ID_REG_AARCH64_X0, arch::ID_REG_AARCH64_X1,
+      arch::ID_REG_AARCH64_X2, arch::ID_REG_AARCH64_X3,
+      arch::ID_REG_AARCH64_X4, arch::ID_REG_AARCH64_X5};
+};
+
+template <> struct ArchTraits<arch::ARCH_ARM32> {
+  static constexpr arch::register_e gpr[GPR_COUNT] = {
+      arch::ID_REG_ARM32_PC, arch::ID_REG_ARM32_SP, arch::ID_REG_ARM32_R11,
+      arch::ID_REG_ARM32_R0};
+  static constexpr arch::register_e args[ARG_REGS] = {
+      arch::ID_REG_ARM32_R0, arch::ID_REG_ARM32_R1, arch::ID_REG_ARM32_R2,
+      arch::ID_REG_ARM32_R3, arch::ID_REG_ARM32_R4, arch::ID_REG_ARM32_R5};
+};
+
+// Calls fn with the traits of the context architecture
+template <typename F> static auto withTraits(Context *ctx, F fn) {
+  switch (ctx->getArchitecture()) {
+  case arch::ARCH_X86_64:
+    return fn(ArchTraits<arch::ARCH_X86_64>{});
+  case arch::ARCH_X86:
+    return fn(ArchTraits<arch::ARCH_X86>{});
+  case arch::ARCH_AARCH64:
+    return fn(ArchTraits<arch::ARCH_AARCH64>{});
+  case arch::ARCH_ARM32:
+    return fn(ArchTraits<arch::ARCH_ARM32>{});
   default:
-    ret = getStack(number + 2); // stack is ip+old_sp+arg1+arg2+...
+    throw std::invalid_argument("unsupported architecture");
   }
-  return ret;
 }
 
-void setArg(int number, const uint64 value) {
-  auto regs = arg_regs[gctx.getArchitecture()];
-  uint64 ret;
-  arch::Register reg;
-  switch (number) {
-  case 0 ... 5:
-    reg = gctx.getRegister(regs[number]);
-    gctx.setConcreteRegisterValue(reg, value);
-    break;
-  default:
-    setStack(number + 2, value); // stack is ip+old_sp+arg1+arg2+...
-  }
+static gpr_e gprFromName(const std::string &name) {
+  if (name == "ip")
+    return GPR_IP;
+  if (name == "sp")
+    return GPR_SP;
+  if (name == "bp")
+    return GPR_BP;
+  if (name == "ret")
+    return GPR_RET;
+  throw std::invalid_argument("unknown general purpose register " + name);
+}
+
+uint64 getStack(Context *ctx, int number) {
+  auto sp_val = getGpr(ctx, GPR_SP);
+  arch::MemoryAccess var(sp_val + number * ctx->getGprSize(),
+                         ctx->getGprSize());
+  return static_cast<uint64>(ctx->getConcreteMemoryValue(var));
+}
+
+void setStack(Context *ctx, int number, const uint64 value) {
+  auto sp_val = getGpr(ctx, GPR_SP);
+  arch::MemoryAccess var(sp_val + number * ctx->getGprSize(),
+                         ctx->getGprSize());
+  ctx->setConcreteMemoryValue(var, value);
+}
+
+const arch::Register &getArgReg(Context *ctx, int number) {
+  return ctx->getRegister(
+      withTraits(ctx, [=](auto t) { return t.args[number]; }));
+}
+
+uint64 getArg(Context *ctx, int number) {
+  if (number < ARG_REGS)
+    return static_cast<uint64>(
+        ctx->getConcreteRegisterValue(getArgReg(ctx, number)));
+  return getStack(ctx, number + 2); // stack is ip+old_sp+arg1+arg2+...
+}
+
+uint64 getArgAddr(Context *ctx, int number) {
+  // stack is ip+old_sp+arg1+arg2+...
+  return getGpr(ctx, GPR_SP) + (number + 2) * ctx->getGprSize();
+}
+
+void setArg(Context *ctx, int number, const uint64 value) {
+  if (number < ARG_REGS)
+    ctx->setConcreteRegisterValue(getArgReg(ctx, number), value);
+  else
+    setStack(ctx, number + 2, value); // stack is ip+old_sp+arg1+arg2+...
+}
+
+arch::register_e getGprId(Context *ctx, gpr_e gpr) {
+  return withTraits(ctx, [=](auto t) { return t.gpr[gpr]; });
+}
+
+uint64 getGpr(Context *ctx, gpr_e gpr) {
+  auto &reg = ctx->getRegister(getGprId(ctx, gpr));
+  return static_cast<uint64>(ctx->getConcreteRegisterValue(reg));
 }
 
-uint64 getGpr(const std::string &name) {
-  auto gpr_regs = gpr[gctx.getArchitecture()];
-  auto reg_id = std::find_if(gpr_regs.begin(), gpr_regs.end(),
-                             [=](auto r) { return r.first == name; });
-  if (reg_id == gpr_regs.end())
-    throw std::invalid_argument("cannot get this general purpose register");
-  auto reg = gctx.getRegister(reg_id->second);
-  return static_cast<uint64>(gctx.getConcreteRegisterValue(reg));
+void setGpr(Context *ctx, gpr_e gpr, const uint64 value) {
+  auto &reg = ctx->getRegister(getGprId(ctx, gpr));
+  ctx->setConcreteRegisterValue(reg, value);
 }
 
-void setGpr(const std::string &name, const uint64 value) {
-  auto gpr_regs = gpr[gctx.getArchitecture()];
-  auto reg_id = std::find_if(gpr_regs.begin(), gpr_regs.end(),
-                             [=](auto r) { return r.first == name; });
-  if (reg_id == gpr_regs.end())
-    throw std::invalid_argument("cannot set this general purpose register");
-  auto reg = gctx.getRegister(reg_id->second);
-  gctx.setConcreteRegisterValue(reg, value);
+uint64 getGpr(Context *ctx, const std::string &name) {
+  return getGpr(ctx, gprFromName(name));
 }
 
-arch::register_e getGprId(const std::string &name) {
-  auto gpr_regs = gpr[gctx.getArchitecture()];
-  auto reg_id = std::find_if(gpr_regs.begin(), gpr_regs.end(),
-                             [=](auto r) { return r.first == name; });
-  if (reg_id == gpr_regs.end())
-    throw std::invalid_argument("cannot get this general purpose register id");
-  return reg_id->second;
+void setGpr(Context *ctx, const std::string &name, const uint64 value) {
+  setGpr(ctx, gprFromName(name), value);
 }
 
-uint64 allocate(uint8 *buf, uint64 size) {
-  gctx.setConcreteMemoryAreaValue(heap_base, buf, size);
-  uint64 ret = heap_base;
-  heap_base += size;
+arch::register_e getGprId(Context *ctx, const std::string &name) {
+  return getGprId(ctx, gprFromName(name));
+}
+
+uint64 allocate(Context *ctx, engines::exploration::GuestHeap *heap, uint8 *buf,
+                uint64 size) {
+  uint64 ret = heap ? heap->malloc(size) : heap_base.fetch_add(size);
+  if (ret == 0)
+    throw std::runtime_error("guest heap exhausted");
+  ctx->setConcreteMemoryAreaValue(ret, buf, size);
   return ret;
 }
 
-std::string toHex(uint64 ptr, uint32 size) {
-  char hex[4];
-  std::string res = "";
-  for (uint32 i = 0; i < size; i++) {
-    snprintf(hex, 3, "%02x ", gctx.getConcreteMemoryValue(ptr + i));
-    res += hex;
+void writeBytes(Context *ctx, uint64 dst, const void *data, uint64 size) {
+  ctx->setConcreteMemoryAreaValue(dst, data, size);
+  for (uint64 i = 0; i < size; i++) {
+    if (ctx->isMemorySymbolized(dst + i))
+      ctx->concretizeMemory(dst + i);
   }
-  return res;
 }
 
-std::string readAsciiString(uint64 ptr, uint64 len) {
-  std::string res = "";
-  for (uint64 i = 0; i < len; i++) {
-    uint8 c = gctx.getConcreteMemoryValue(ptr + i);
-    if ((c < 0x20) || (c > 0x7F))
-      break;
-    res += c;
+void copyMemory(Context *ctx, uint64 dst, uint64 src, uint64 size) {
+  // one page of the source at a time, as GuestReader reads
+  constexpr uint64 page = 0x1000;
+  for (uint64 done = 0; done < size;) {
+    uint64 from = src + done;
+    uint64 to = dst + done;
+    uint64 chunk = std::min(page - (from & (page - 1)), size - done);
+    auto mem = ctx->getConcreteMemoryAreaValue(from, chunk);
+    ctx->setConcreteMemoryAreaValue(to, mem);
+    done += chunk;
+
+    // symbolic bytes keep their expression, concrete ones overwrite it
+    auto n = static_cast<uint32>(chunk);
+    if (!ctx->isMemorySymbolized(from, n) && !ctx->isMemorySymbolized(to, n))
+      continue;
+    for (uint64 i = 0; i < chunk; i++) {
+      if (!ctx->isMemorySymbolized(from + i)) {
+        if (ctx->isMemorySymbolized(to + i))
+          ctx->concretizeMemory(to + i);
+        continue;
+      }
+      auto node = ctx->getMemoryAst(arch::MemoryAccess(from + i, 1));
+      auto expr = ctx->newSymbolicExpression(node, "copy");
+      ctx->assignSymbolicExpressionToMemory(expr,
+                                            arch::MemoryAccess(to + i, 1));
+    }
   }
-  return res;
 }
 
-std::string readUtf8String(uint64 ptr, uint64 len) {
-  std::string res = "";
-  for (uint64 i = 0; i < len; i++) {
-    uint8 c = gctx.getConcreteMemoryValue(ptr + i);
-    if (c == 0)
+GuestBytes GuestReader::read(Context *ctx, uint64 ptr, uint64 len,
+                             bool cstring) {
+  constexpr uint64 page = 0x1000;
+  GuestBytes res = {{}, false, false};
+
+  this->buf.clear();
+  while (this->buf.size() < len) {
+    uint64 addr = ptr + this->buf.size();
+    uint64 chunk = std::min(page - (addr & (page - 1)), len - this->buf.size());
+    auto mem = ctx->getConcreteMemoryAreaValue(addr, chunk);
+
+    uint64 n = chunk;
+    if (cstring) {
+      auto nul = std::memchr(mem.data(), 0, chunk);
+      if (nul != nullptr) {
+        n = static_cast<const uint8 *>(nul) - mem.data();
+        res.terminated = true;
+      }
+    }
+
+    // the terminator decides the length, it counts as well
+    uint64 checked = n + (res.terminated ? 1 : 0);
+    if (!res.symbolic && checked &&
+        ctx->isMemorySymbolized(addr, static_cast<uint32>(checked)))
+      res.symbolic = true;
+
+    this->buf.append(reinterpret_cast<const char *>(mem.data()), n);
+    if (res.terminated)
       break;
-    res += c;
   }
+
+  res.data = this->buf;
   return res;
 }
 
-uint64 lenString(uint64 ptr) {
-  uint64 res;
-  for (res = 0;; res++) {
-    uint8 c = gctx.getConcreteMemoryValue(ptr + res);
-    if (c == 0)
-      break;
+GuestBytes GuestReader::cstring(Context *ctx, uint64 ptr, uint64 max) {
+  return this->read(ctx, ptr, max, true);
+}
+
+GuestBytes GuestReader::bytes(Context *ctx, uint64 ptr, uint64 len) {
+  return this->read(ctx, ptr, len, false);
+}
+
+static thread_local GuestReader reader;
+
+GuestBytes readCString(Context *ctx, uint64 ptr, uint64 max) {
+  return reader.cstring(ctx, ptr, max);
+}
+
+GuestBytes readBytes(Context *ctx, uint64 ptr, uint64 len) {
+  return reader.bytes(ctx, ptr, len);
+}
+
+std::string toHex(Context *ctx, uint64 ptr, uint32 size) {
+  static const char digits[] = "0123456789abcdef";
+  auto mem = readBytes(ctx, ptr, size).data;
+  std::string res;
+  res.reserve(mem.size() * 3);
+  for (unsigned char c : mem) {
+    res += digits[c >> 4];
+    res += digits[c & 0xf];
+    res += ' ';
   }
   return res;
 }
 
-// print stuff
+std::string readAsciiString(Context *ctx, uint64 ptr, uint64 len) {
+  auto str = readCString(ctx, ptr, len).data;
+  auto end = std::find_if(str.begin(), str.end(), [](unsigned char c) {
+    return (c < 0x20) || (c > 0x7F);
+  });
+  return std::string(str.begin(), end);
+}
+
+std::string readUtf8String(Context *ctx, uint64 ptr, uint64 len) {
+  return std::string(readCString(ctx, ptr, len).data);
+}
 
-uint64 printfArgAmount(const std::string &format) {
-  std::regex const re("%[0-9$#xXzldos]*");
-  std::ptrdiff_t const count(
-      std::distance(std::sregex_iterator(format.begin(), format.end(), re),
-                    std::sregex_iterator()));
-  return count;
+uint64 lenString(Context *ctx, uint64 ptr) {
+  return readCString(ctx, ptr).data.size();
 }
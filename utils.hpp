@@ -1,43 +1,100 @@
-
 #ifndef KRACKME_UTILS_H
 #define KRACKME_UTILS_H
 
+#include <limits>
+#include <string>
+#include <string_view>
 #include <triton/context.hpp>
 
 using namespace triton;
 
+// log levels, the level is chosen at compile time (-DTT_LOG_LEVEL=n)
+#define TT_LOG_NONE 0
+#define TT_LOG_INFO 1
+#define TT_LOG_DEBUG 2
+#ifndef TT_LOG_LEVEL
+#define TT_LOG_LEVEL TT_LOG_INFO
+#endif
+
 #define debug_printf(format, ...)                                              \
 {                                                                              \
-    if (DEBUG)                                                                 \
+    if (TT_LOG_LEVEL >= TT_LOG_DEBUG)                                          \
 	std::printf("\x1b[31m" format "\x1b[0m", __VA_ARGS__);                 \
 }
 #define debug_puts(str)                                                        \
 {                                                                              \
-    if (DEBUG)                                                                 \
+    if (TT_LOG_LEVEL >= TT_LOG_DEBUG)                                          \
 	std::puts("\x1b[31m" str "\x1b[0m");                                   \
 }
 #define triton_printf(format, ...)                                             \
 {                                                                              \
-    std::printf("\x1b[33m" format "\x1b[0m", __VA_ARGS__);                     \
+    if (TT_LOG_LEVEL >= TT_LOG_INFO)                                           \
+	std::printf("\x1b[33m" format "\x1b[0m", __VA_ARGS__);                 \
 }
 #define triton_puts(str)                                                       \
 {                                                                              \
-    std::puts("\x1b[33m" str "\x1b[0m");                                       \
+    if (TT_LOG_LEVEL >= TT_LOG_INFO)                                           \
+	std::puts("\x1b[33m" str "\x1b[0m");                                   \
+}
+
+// general purpose registers known by every architecture
+enum gpr_e { GPR_IP = 0, GPR_SP, GPR_BP, GPR_RET, GPR_COUNT };
+// arguments passed in registers, the next ones are on the stack
+constexpr int ARG_REGS = 6;
+
+uint64 getStack(Context *ctx, int number);
+void setStack(Context *ctx, int number, const uint64 value);
+const arch::Register &getArgReg(Context *ctx, int number);
+uint64 getArg(Context *ctx, int number);
+// address of an argument passed on the stack, number >= ARG_REGS
+uint64 getArgAddr(Context *ctx, int number);
+void setArg(Context *ctx, int number, const uint64 value);
+uint64 getGpr(Context *ctx, gpr_e gpr);
+void setGpr(Context *ctx, gpr_e gpr, const uint64 value);
+arch::register_e getGprId(Context *ctx, gpr_e gpr);
+// string wrappers: "ip", "sp", "bp" or "ret"
+uint64 getGpr(Context *ctx, const std::string &name);
+void setGpr(Context *ctx, const std::string &name, const uint64 value);
+arch::register_e getGprId(Context *ctx, const std::string &name);
+// bytes of guest memory, read in page sized chunks
+struct GuestBytes {
+  std::string_view data; // without the NUL terminator
+  bool symbolic;         // a byte of data (or its terminator) is symbolic
+  bool terminated;       // a NUL has been found before the limit
+};
+
+// owns the storage of what it reads, a result is valid until its next read
+class GuestReader {
+  std::string buf;
+  GuestBytes read(Context *ctx, uint64 ptr, uint64 len, bool cstring);
+
+public:
+  // up to the first NUL, at most max bytes
+  GuestBytes cstring(Context *ctx, uint64 ptr,
+                     uint64 max = std::numeric_limits<uint64>::max());
+  // exactly len bytes
+  GuestBytes bytes(Context *ctx, uint64 ptr, uint64 len);
+};
+
+// same as GuestReader, on a reader per thread
+GuestBytes readCString(Context *ctx, uint64 ptr,
+                       uint64 max = std::numeric_limits<uint64>::max());
+GuestBytes readBytes(Context *ctx, uint64 ptr, uint64 len);
+
+namespace triton::engines::exploration {
+class GuestHeap;
 }
 
-uint64 getStack(int number);
-void setStack(int number, const uint64 value);
-arch::Register getArgReg(int number);
-uint64 getArg(int number);
-void setArg(int number, const uint64 value);
-uint64 getGpr(const std::string &name);
-void setGpr(const std::string &name, const uint64 value);
-arch::register_e getGprId(const std::string &name);
-uint64 allocate(uint8 *buf, uint64 size);
-std::string toHex(uint64 ptr, uint32 size);
-std::string readAsciiString(uint64 ptr, uint64 len);
-std::string readUtf8String(uint64 ptr, uint64 len);
-uint64 lenString(uint64 ptr);
-uint64 printfArgAmount(std::string format);
+// on heap if not null
+uint64 allocate(Context *ctx, engines::exploration::GuestHeap *heap, uint8 *buf,
+                uint64 size);
+// write host bytes to guest memory, the written bytes become concrete
+void writeBytes(Context *ctx, uint64 dst, const void *data, uint64 size);
+// copy guest memory page by page, symbolic bytes included
+void copyMemory(Context *ctx, uint64 dst, uint64 src, uint64 size);
+std::string toHex(Context *ctx, uint64 ptr, uint32 size);
+std::string readAsciiString(Context *ctx, uint64 ptr, uint64 len);
+std::string readUtf8String(Context *ctx, uint64 ptr, uint64 len);
+uint64 lenString(Context *ctx, uint64 ptr);
 
 #endif
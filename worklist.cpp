@@ -0,0 +1,134 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#include "worklist.hpp"
+
+namespace triton {
+namespace engines {
+namespace exploration {
+
+WorkStealingQueue::WorkStealingQueue() {
+  this->pending = 0;
+  this->active = 0;
+  this->order = 0;
+  this->aborted = false;
+}
+
+void WorkStealingQueue::resize(triton::usize workers, schedule_e policy,
+                               triton::usize restart, triton::uint64 seed) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->lanes.clear();
+  for (triton::usize i = 0; i < workers; i++) {
+    auto lane = std::make_unique<lane_s>();
+    lane->seeds = Scheduler::create(policy, restart, seed + i);
+    this->lanes.push_back(std::move(lane));
+  }
+  this->pending = 0;
+  this->active = 0;
+  this->order = 0;
+  this->aborted = false;
+}
+
+void WorkStealingQueue::push(triton::usize id, SeedEntry entry) {
+  /* Count the seed before it becomes visible so that it can never be popped
+   * while the queue looks exhausted */
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->pending++;
+    entry.order = this->order++;
+  }
+  {
+    auto &lane = this->lanes[id % this->lanes.size()];
+    std::lock_guard<std::mutex> guard(lane->lock);
+    lane->seeds->push(std::move(entry));
+  }
+  this->cond.notify_one();
+}
+
+bool WorkStealingQueue::tryPop(triton::usize id, SeedEntry &entry) {
+  const triton::usize n = this->lanes.size();
+
+  /* Own lane first */
+  {
+    auto &lane = this->lanes[id % n];
+    std::lock_guard<std::mutex> guard(lane->lock);
+    if (lane->seeds->pop(entry)) {
+      return true;
+    }
+  }
+
+  /* Steal from another lane */
+  for (triton::usize i = 1; i < n; i++) {
+    auto &lane = this->lanes[(id + i) % n];
+    std::lock_guard<std::mutex> guard(lane->lock);
+    if (lane->seeds->steal(entry)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool WorkStealingQueue::pop(triton::usize id, SeedEntry &entry,
+                            std::shared_lock<std::shared_mutex> &hold) {
+  while (true) {
+    hold.lock();
+    if (this->tryPop(id, entry)) {
+      std::lock_guard<std::mutex> guard(this->lock);
+      this->pending--;
+      this->active++;
+      return !this->aborted;
+    }
+    hold.unlock();
+
+    std::unique_lock<std::mutex> guard(this->lock);
+    if (this->aborted || (this->pending == 0 && this->active == 0)) {
+      this->cond.notify_all();
+      return false;
+    }
+    this->cond.wait(guard, [this] {
+      return this->aborted || this->pending > 0 || this->active == 0;
+    });
+  }
+}
+
+void WorkStealingQueue::done(void) {
+  this->release();
+}
+
+void WorkStealingQueue::retain(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->active++;
+}
+
+void WorkStealingQueue::release(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->active--;
+  if (this->active == 0 && this->pending == 0) {
+    this->cond.notify_all();
+  }
+}
+
+void WorkStealingQueue::abort(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->aborted = true;
+  this->cond.notify_all();
+}
+
+triton::usize WorkStealingQueue::size(void) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->pending;
+}
+
+void WorkStealingQueue::copy(std::vector<SeedEntry> &out) {
+  for (auto &lane : this->lanes) {
+    std::lock_guard<std::mutex> guard(lane->lock);
+    lane->seeds->copy(out);
+  }
+}
+
+}; // namespace exploration
+}; // namespace engines
+}; // namespace triton
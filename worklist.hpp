@@ -0,0 +1,125 @@
+//! \file
+/*
+**  This program is under the terms of the Apache License 2.0.
+*/
+
+#ifndef TRITON_WORKLIST_H
+#define TRITON_WORKLIST_H
+
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include <triton/tritonTypes.hpp>
+
+#include "scheduler.hpp"
+
+
+
+//! The Triton namespace
+namespace triton {
+/*!
+ *  \addtogroup triton
+ *  @{
+ */
+
+  //! The Engines namespace
+  namespace engines {
+  /*!
+   *  \ingroup triton
+   *  \addtogroup engines
+   *  @{
+   */
+
+    //! The Symbolic Exploration namespace
+    namespace exploration {
+    /*!
+     *  \ingroup engines
+     *  \addtogroup symbolic
+     *  @{
+     */
+
+      /*! \class WorkStealingQueue
+          \brief A worklist split in one lane per worker.
+
+          A worker pushes and pops in its own lane, in the order of the
+          lane scheduler, and steals from the other lanes when its own one is
+          empty. The queue is exhausted when no seed is pending and no worker
+          (or retained job) may produce one. */
+      class WorkStealingQueue {
+        private:
+          //! One lane per worker.
+          struct lane_s {
+            std::mutex lock;
+            std::unique_ptr<Scheduler> seeds;
+          };
+
+          //! Lanes of the queue.
+          std::vector<std::unique_ptr<lane_s>> lanes;
+
+          //! Protects the counters below.
+          std::mutex lock;
+
+          //! Signaled when a seed is pushed or when the queue drains.
+          std::condition_variable cond;
+
+          //! Number of seeds in the lanes.
+          triton::usize pending;
+
+          //! Number of seeds being processed and retained jobs.
+          triton::usize active;
+
+          //! Number of seeds pushed so far.
+          triton::usize order;
+
+          //! True when the exploration has been aborted.
+          bool aborted;
+
+          //! Try to pop a seed from the own lane, then steal from the others.
+          bool tryPop(triton::usize id, SeedEntry& entry);
+
+        public:
+          //! Constructor.
+          WorkStealingQueue();
+
+          //! Reset the queue with one lane per worker, scheduled with the given policy.
+          void resize(triton::usize workers, schedule_e policy, triton::usize restart, triton::uint64 seed);
+
+          //! Push a seed in the lane of the given worker.
+          void push(triton::usize id, SeedEntry entry);
+
+          //! Pop a seed, blocks until one is available. Returns false when the queue is exhausted.
+          /*! hold is locked around each attempt and left locked on success, so that the
+              caller can publish the seed before anyone holding the exclusive side looks. */
+          bool pop(triton::usize id, SeedEntry& entry, std::shared_lock<std::shared_mutex>& hold);
+
+          //! Mark a popped seed as processed.
+          void done(void);
+
+          //! Keep the queue alive while an asynchronous producer is running.
+          void retain(void);
+
+          //! Release a previous retain.
+          void release(void);
+
+          //! Wake up all workers and make pop() fail.
+          void abort(void);
+
+          //! Number of pending seeds.
+          triton::usize size(void);
+
+          //! Append a copy of every pending seed to out.
+          void copy(std::vector<SeedEntry>& out);
+      };
+
+    /*! @} End of exploration namespace */
+    };
+  /*! @} End of engines namespace */
+  };
+/*! @} End of triton namespace */
+};
+
+#endif /* TRITON_WORKLIST_H */